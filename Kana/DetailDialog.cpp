@@ -1,61 +1,37 @@
 #include "DetailDialog.h"
+#include "kanacatalog.h"
+#include "strokeimagecache.h"
+#include "audioservice.h"
+#include "trace.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QMediaPlayer>
-#include <QAudioOutput>
-#include <QUrl>
-#include <QFile>
 #include <QDebug>
 #include <QResizeEvent>
-#include <QRegularExpression>
-
-// Deleting ()
-static QString displayRomaji(QString s)
-{
-    s.remove(QRegularExpression(R"(\s*\([^)]*\))"));
-    return s.trimmed();
-}
-
-static QString toKatakana(const QString &h)
-{
-    QString out = h;
-    for (int i = 0; i < out.size(); ++i) {
-        ushort u = out[i].unicode();
-        if (u >= 0x3041 && u <= 0x3096)
-            out[i] = QChar(u + 0x60);
-    }
-    return out;
-}
-
-static QString toHiragana(const QString &k)
-{
-    QString out = k;
-    for (int i = 0; i < out.size(); ++i) {
-        ushort u = out[i].unicode();
-        if (u >= 0x30A1 && u <= 0x30F6)
-            out[i] = QChar(u - 0x60);
-    }
-    return out;
-}
 
 DetailDialog::DetailDialog(const QString &kana,
                            const QString &romaji,
                            bool isHiragana,
                            QWidget *parent)
     : QDialog(parent),
+    m_id(KanaCatalog::idOfRomaji(romaji)),
     m_romaji(romaji),
     m_isHiragana(isHiragana)
 {
-    m_kana_hira = isHiragana ? kana : toHiragana(kana);
-    m_kana_kata = toKatakana(m_kana_hira);
+    KANA_TRACE_SCOPE("DetailDialog::DetailDialog");
+
+    m_kana_hira = KanaCatalog::isValid(m_id) ? KanaCatalog::kana(m_id, true)  : kana;
+    m_kana_kata = KanaCatalog::isValid(m_id) ? KanaCatalog::kana(m_id, false) : kana;
 
     setModal(true);
     setWindowTitle("Kana");
     setWindowFlags(Qt::Dialog | Qt::WindowTitleHint | Qt::WindowCloseButtonHint);
 
+    connect(StrokeImageCache::instance(), &StrokeImageCache::ready,
+            this, &DetailDialog::onStrokeReady);
+
     buildUi();
     loadContent();
 
@@ -119,7 +95,7 @@ void DetailDialog::buildUi()
     strokeLabel = new QLabel();
     strokeLabel->setAlignment(Qt::AlignCenter);
     strokeLabel->setMinimumHeight(300);
-    strokeLabel->setStyleSheet("background:#111; border-radius:16px;");
+    strokeLabel->setStyleSheet("background:#111; border-radius:16px; color:#666; font-size:24pt;");
     root->addWidget(strokeLabel, 1);
 }
 
@@ -127,7 +103,7 @@ void DetailDialog::loadContent()
 {
     lblKana->setText(m_isHiragana ? m_kana_hira : m_kana_kata);
     lblScript->setText(m_isHiragana ? "Hiragana" : "Katakana");
-    lblRomaji->setText(displayRomaji(m_romaji));
+    lblRomaji->setText(KanaCatalog::displayRomaji(m_id));
 
     loadSound();
     loadStrokeImage();
@@ -135,31 +111,21 @@ void DetailDialog::loadContent()
 
 void DetailDialog::loadSound()
 {
-    QString path = QString("data/sounds/%1.mp3").arg(displayRomaji(m_romaji));
+    AudioService *audio = AudioService::instance();
 
-    if (!QFile::exists(path)) {
-        qDebug() << "NO SOUND:" << path;
+    if (!audio->hasClip(m_id)) {
+        qDebug() << "NO SOUND:" << AudioService::pathFor(m_id);
         btnSound->setEnabled(false);
         return;
     }
 
     btnSound->setEnabled(true);
-
-    if (!m_player) {
-        m_player = new QMediaPlayer(this);
-        m_audio  = new QAudioOutput(this);
-        m_player->setAudioOutput(m_audio);
-        m_audio->setVolume(1.0);
-    }
-
-    m_player->setSource(QUrl::fromLocalFile(path));
+    audio->preload(m_id);
 }
 
 void DetailDialog::playSound()
 {
-    if (!m_player) return;
-    m_player->stop();
-    m_player->play();
+    AudioService::instance()->play(m_id);
 }
 
 void DetailDialog::switchScript()
@@ -170,18 +136,19 @@ void DetailDialog::switchScript()
 
 void DetailDialog::loadStrokeImage()
 {
-    QString prefix = m_isHiragana ? "hira_" : "kata_";
-    QString path   = QString("data/strokes/%1%2.jpg")
-                       .arg(prefix, m_romaji);
+    StrokeImageCache *cache = StrokeImageCache::instance();
 
-    if (!QFile::exists(path)) {
+    if (!cache->hasImage(m_isHiragana, m_romaji)) {
+        m_strokeKey.clear();
         strokeLabel->setVisible(false);
         return;
     }
 
-    m_strokePixmap.load(path);
     strokeLabel->setVisible(true);
-    updateStrokePixmap();
+    updateStrokePixmap(false);
+
+    // The other script is one click away
+    cache->prefetch(!m_isHiragana, m_romaji, strokeLabel->size());
 }
 
 void DetailDialog::resizeEvent(QResizeEvent *event)
@@ -190,15 +157,25 @@ void DetailDialog::resizeEvent(QResizeEvent *event)
     updateStrokePixmap();
 }
 
-void DetailDialog::updateStrokePixmap()
+// Cached per size bucket; on a miss the old pixmap stays until it's ready,
+// unless it belongs to another symbol or script
+void DetailDialog::updateStrokePixmap(bool keepOnMiss)
 {
-    if (m_strokePixmap.isNull()) return;
-
-    strokeLabel->setPixmap(
-        m_strokePixmap.scaled(
-            strokeLabel->size(),
-            Qt::KeepAspectRatio,
-            Qt::SmoothTransformation
-            )
-        );
+    if (strokeLabel->isHidden()) return;
+
+    const QSize target = strokeLabel->size();
+    m_strokeKey = StrokeImageCache::keyFor(m_isHiragana, m_romaji,
+                                           StrokeImageCache::bucketFor(target));
+
+    QPixmap pm;
+    if (StrokeImageCache::instance()->pixmap(m_isHiragana, m_romaji, target, &pm))
+        strokeLabel->setPixmap(pm);
+    else if (!keepOnMiss)
+        strokeLabel->setText("…");   // placeholder until onStrokeReady()
+}
+
+void DetailDialog::onStrokeReady(const QString &key)
+{
+    if (key == m_strokeKey)
+        updateStrokePixmap();
 }
@@ -2,12 +2,9 @@
 #define DETAILDIALOG_H
 
 #include <QDialog>
-#include <QPixmap>
 
 class QLabel;
 class QPushButton;
-class QMediaPlayer;
-class QAudioOutput;
 
 class DetailDialog : public QDialog
 {
@@ -30,8 +27,12 @@ private:
     void loadContent();
     void loadSound();
     void loadStrokeImage();
-    void updateStrokePixmap();
+    // keepOnMiss: the label already shows this symbol (resize), so the
+    // old pixmap can stand in until the new size is decoded
+    void updateStrokePixmap(bool keepOnMiss = true);
+    void onStrokeReady(const QString &key);
 
+    int     m_id;        // KanaCatalog id
     QString m_kana_hira;
     QString m_kana_kata;
     QString m_romaji;
@@ -44,10 +45,7 @@ private:
     QPushButton  *btnSwitch;
     QLabel       *strokeLabel;
 
-    QMediaPlayer *m_player = nullptr;
-    QAudioOutput *m_audio  = nullptr;
-
-    QPixmap       m_strokePixmap;
+    QString       m_strokeKey;   // StrokeImageCache key being shown or awaited
 };
 
 #endif
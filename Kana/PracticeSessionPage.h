@@ -7,29 +7,29 @@
 #include <QPushButton>
 #include <QGraphicsOpacityEffect>
 #include <QPropertyAnimation>
+#include <QElapsedTimer>
 
 #include "practiceconfig.h"
 #include "progressmanager.h"
+#include "quizengine.h"
 
-struct QuizKanaItem
-{
-    QString kana;
-    QString romaji;
-    bool    isHiragana = true;
-};
-
+class QTimer;
 
 class PracticeSessionPage : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit PracticeSessionPage(QWidget *parent = nullptr);
+    explicit PracticeSessionPage(ProgressManager *progress, QWidget *parent = nullptr);
     void startSession(const PracticeConfig &config);
 
 signals:
     void backToSetup();
 
+protected:
+    // 1-4 answer, Enter moves on
+    void keyPressEvent(QKeyEvent *event) override;
+
 private slots:
     void answer(int index);
     void nextQuestion();
@@ -40,26 +40,31 @@ private:
     void buildUi();
     void finishSession();
     void stopSession();
-    // Test logic
-    void buildKanaPool();
+    // Test logic (the quiz itself lives in QuizEngine)
     void askQuestion();
-    QString romajiOf(const QString &kana);
-    QSet<QString> m_masteredRomaji;
-    void loadMasteredFromStats();
+    bool inTransition() const;
+    void updateDrillClock();
 
 private:
     PracticeConfig m_config;
 
-    QVector<QuizKanaItem> m_all;
-    QVector<QuizKanaItem> m_pool;
-
+    QuizEngine   m_engine;
     QuizKanaItem m_current;
+    QuizKanaItem m_next;          // picked one question ahead, for prefetching
+    PreparedQuestion m_prepared;
 
+    int  m_optionIds[4] = { -1, -1, -1, -1 };   // KanaCatalog id per option button
     int  m_correctIndex = 0;
     int  m_questionIndex = 0;
     int  m_correctCount = 0;
+    int  m_answered = 0;
     bool m_showKana = true;
     bool m_active = false;
+    QElapsedTimer m_answerTimer;   // question fully shown (fade-in done) -> answered
+
+    int     m_bufferedAnswer = -1;    // key pressed between questions
+    quint8  m_styledOptions = 0;      // option buttons not in the normal style
+    QElapsedTimer m_drillClock;
 
     ProgressManager *progress = nullptr;
 
@@ -69,6 +74,7 @@ private:
     QLabel *lblCounter  = nullptr;
     QLabel *lblQuestion = nullptr;
     QLabel *lblSubtitle = nullptr;
+    QPushButton *btnReplay = nullptr;
     QLabel *lblFeedback = nullptr;
 
     QPushButton *opt[4] = {};
@@ -85,6 +91,10 @@ private:
     QGraphicsOpacityEffect *opacity = nullptr;
     QPropertyAnimation     *fadeOut = nullptr;
     QPropertyAnimation     *fadeIn  = nullptr;
+
+    // Speed drill: pause after a wrong answer, countdown
+    QTimer *advanceTimer = nullptr;
+    QTimer *drillTick    = nullptr;
 };
 
 #endif // PRACTICESESSIONPAGE_H
@@ -1,21 +1,51 @@
-#include "statisticspage.h"
-#include "wordapiservice.h"
+#include "StatisticsPage.h"
+#include "WordApiService.h"
+#include "kanacatalog.h"
+#include "progressmanager.h"
+#include "masteredview.h"
+#include "trace.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QScrollArea>
 #include <QPushButton>
-#include <QFile>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QMap>
+#include <QLineEdit>
+#include <algorithm>
+#include <iterator>
 
 
-StatisticsPage::StatisticsPage(QWidget *parent)
+StatisticsPage::StatisticsPage(ProgressManager *progress, QWidget *parent)
     : QWidget(parent)
+    , progress(progress)
 {
     buildUi();
+
+    std::fill(std::begin(m_shown), std::end(m_shown), -1);
+    updateTotals();
+
+    QVector<int> hira, kata;
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+    {
+        if (progress->isMastered(true, id))
+        {
+            hira.append(id);
+            m_masteredSet.insert(true, id);
+        }
+        if (progress->isMastered(false, id))
+        {
+            kata.append(id);
+            m_masteredSet.insert(false, id);
+        }
+    }
+    hiraMastered->setMastered(hira);
+    kataMastered->setMastered(kata);
+    wordService->setMasteredFilter(m_masteredSet);
+
+    // Follow the shared model instead of re-reading the stats file
+    connect(progress, &ProgressManager::totalsChanged,
+            this, &StatisticsPage::updateTotals);
+    connect(progress, &ProgressManager::symbolChanged,
+            this, &StatisticsPage::updateSymbol);
 }
 
 
@@ -40,6 +70,7 @@ void StatisticsPage::buildUi()
     // Top bar
     auto *top = new QHBoxLayout();
     btnHome = new QPushButton("← Home");
+    btnHome->setObjectName("homeButton");
     btnHome->setStyleSheet(
         "QPushButton { background:#333; color:white; padding:6px 14px;"
         "border-radius:8px; font-size:11pt; }"
@@ -74,12 +105,16 @@ void StatisticsPage::buildUi()
     lblHiraCorrect = new QLabel();
     lblHiraWrong   = new QLabel();
     lblHiraStreak  = new QLabel();
-    hiraMasteredWidget = new QWidget();
+    lblHiraSpeed   = new QLabel();
+    lblHiraSlowest = new QLabel();
+    hiraMastered = new MasteredView(true);
 
     rootLayout->addWidget(lblHiraCorrect);
     rootLayout->addWidget(lblHiraWrong);
     rootLayout->addWidget(lblHiraStreak);
-    rootLayout->addWidget(hiraMasteredWidget);
+    rootLayout->addWidget(lblHiraSpeed);
+    rootLayout->addWidget(lblHiraSlowest);
+    rootLayout->addWidget(hiraMastered);
 
     // Katakana
     auto *kataTitle = new QLabel("Katakana");
@@ -89,12 +124,16 @@ void StatisticsPage::buildUi()
     lblKataCorrect = new QLabel();
     lblKataWrong   = new QLabel();
     lblKataStreak  = new QLabel();
-    kataMasteredWidget = new QWidget();
+    lblKataSpeed   = new QLabel();
+    lblKataSlowest = new QLabel();
+    kataMastered = new MasteredView(false);
 
     rootLayout->addWidget(lblKataCorrect);
     rootLayout->addWidget(lblKataWrong);
     rootLayout->addWidget(lblKataStreak);
-    rootLayout->addWidget(kataMasteredWidget);
+    rootLayout->addWidget(lblKataSpeed);
+    rootLayout->addWidget(lblKataSlowest);
+    rootLayout->addWidget(kataMastered);
 
     rootLayout->addStretch();
 
@@ -132,7 +171,35 @@ void StatisticsPage::buildUi()
     cardLayout->addWidget(lblWordRomaji);
     cardLayout->addWidget(lblWordMeaning);
     cardLayout->addSpacing(6);
-    cardLayout->addWidget(btnNewWord, 0, Qt::AlignCenter);
+    btnMasteredOnly = new QPushButton("Mastered kana only");
+    btnMasteredOnly->setCheckable(true);
+    btnMasteredOnly->setStyleSheet(
+        "QPushButton { background:#444; color:white; padding:6px 14px;"
+        "border-radius:8px; }"
+        "QPushButton:hover { background:#555; }"
+        "QPushButton:checked { background:#8bc34a; color:black; }"
+        );
+
+    auto *wordButtons = new QHBoxLayout();
+    wordButtons->addStretch();
+    wordButtons->addWidget(btnNewWord);
+    wordButtons->addWidget(btnMasteredOnly);
+    wordButtons->addStretch();
+    cardLayout->addLayout(wordButtons);
+
+    editSearch = new QLineEdit();
+    editSearch->setPlaceholderText("Look up a word by kana or romaji…");
+    editSearch->setClearButtonEnabled(true);
+    editSearch->setStyleSheet(
+        "QLineEdit { background:#333; color:white; padding:6px 10px;"
+        "border-radius:8px; font-size:12pt; }"
+        );
+    cardLayout->addWidget(editSearch);
+
+    lblFilterNote = new QLabel("No word uses only your mastered kana yet — showing any word");
+    lblFilterNote->setAlignment(Qt::AlignCenter);
+    lblFilterNote->hide();
+    cardLayout->addWidget(lblFilterNote);
 
     wordCard->setStyleSheet(
         "background:#2b2b2b;"
@@ -152,6 +219,7 @@ void StatisticsPage::buildUi()
                 lblWordKana->setText(kana);
                 lblWordRomaji->setText(romaji);
                 lblWordMeaning->setText(meaning);
+                lblFilterNote->setVisible(wordService->filterFellBack());
             });
 
     connect(btnNewWord, &QPushButton::clicked, this, [this]() {
@@ -161,167 +229,139 @@ void StatisticsPage::buildUi()
         wordService->fetchWord();
     });
 
+    connect(editSearch, &QLineEdit::returnPressed, this, [this]() {
+        if (editSearch->text().trimmed().isEmpty())
+            return;
+        lblWordMeaning->setText("Searching...");
+        wordService->searchWord(editSearch->text());
+    });
+
+    connect(wordService, &WordApiService::noWordFound, this, [this](const QString &text) {
+        lblWordKana->setText("—");
+        lblWordRomaji->setText("");
+        lblWordMeaning->setText("No word starts with \"" + text + "\"");
+        lblFilterNote->hide();
+    });
+
+    connect(btnMasteredOnly, &QPushButton::toggled, this, [this](bool on) {
+        wordService->setMasteredOnly(on);
+        wordService->fetchWord();
+    });
+
     for (auto *lbl : content->findChildren<QLabel*>())
     {
         if (lbl == title || lbl == summaryTitle || lbl == hiraTitle || lbl == kataTitle)
             continue;
 
+        if (lbl == lblFilterNote)
+        {
+            lbl->setStyleSheet("color:#bbbbbb; font-size:11pt;");
+            lbl->setWordWrap(true);
+            continue;
+        }
+
         lbl->setStyleSheet("color:white; font-size:14pt;");
         lbl->setWordWrap(true);
     }
 }
 
-// Load stats
+// Page shown: counters are already current; the word changes and the
+// response times catch up with answers given while the page was hidden
 void StatisticsPage::loadStats()
 {
-    QFile f("data/user_stats.json");
-    if (!f.open(QIODevice::ReadOnly))
-        return;
-
-    auto doc = QJsonDocument::fromJson(f.readAll());
-    f.close();
+    KANA_TRACE_SCOPE("StatisticsPage::loadStats");
 
-    auto obj  = doc.object();
-    auto hira = obj["hiragana"].toObject();
-    auto kata = obj["katakana"].toObject();
-    auto pr   = obj["practice"].toObject();
-
-    int totalAnswered = pr["totalAnswered"].toInt();
-    int totalCorrect  = pr["totalCorrect"].toInt();
-    double acc = totalAnswered ? (100.0 * totalCorrect / totalAnswered) : 0;
-
-    lblTotal->setText("Total answered: " + QString::number(totalAnswered));
-    lblAccuracy->setText("Accuracy: " + QString::number(acc, 'f', 1) + "%");
-
-    lblHiraCorrect->setText("Correct: " + QString::number(hira["correct"].toInt()));
-    lblHiraWrong->setText("Wrong: " + QString::number(hira["wrong"].toInt()));
-    lblHiraStreak->setText("Streak: " + QString::number(hira["streak"].toInt()));
-
-    QStringList hm;
-    for (auto v : hira["mastered"].toArray()) hm << v.toString();
-
-    delete hiraMasteredWidget->layout();
-    auto *hiraLayout = new QHBoxLayout(hiraMasteredWidget);
-    hiraLayout->addWidget(createMasteredRow(hm, true));
-
-    lblKataCorrect->setText("Correct: " + QString::number(kata["correct"].toInt()));
-    lblKataWrong->setText("Wrong: " + QString::number(kata["wrong"].toInt()));
-    lblKataStreak->setText("Streak: " + QString::number(kata["streak"].toInt()));
-
-    QStringList km;
-    for (auto v : kata["mastered"].toArray()) km << v.toString();
-
-    delete kataMasteredWidget->layout();
-    auto *kataLayout = new QHBoxLayout(kataMasteredWidget);
-    kataLayout->addWidget(createMasteredRow(km, false));
+    updateLatency(true);
+    updateLatency(false);
     wordService->fetchWord();
 }
 
-// Mastered situation
-QWidget* StatisticsPage::createMasteredRow(const QStringList& list, bool hira)
+void StatisticsPage::updateTotals()
 {
-    auto *row = new QWidget();
-    auto *l = new QHBoxLayout(row);
-    l->setSpacing(12);
+    KANA_TRACE_SCOPE("StatisticsPage::updateTotals");
+
+    const int values[CounterCount] = {
+        progress->getTotalAnswered(), progress->getTotalCorrect(),
+        progress->getCorrect(true),  progress->getWrong(true),  progress->getStreak(true),
+        progress->getCorrect(false), progress->getWrong(false), progress->getStreak(false)
+    };
 
-    for (const auto& r : list)
-        l->addWidget(createMasteredCard(kanaFromRomaji(r, hira), r));
+    if (values[Total] != m_shown[Total] || values[Correct] != m_shown[Correct])
+    {
+        const int totalAnswered = values[Total];
+        double acc = totalAnswered ? (100.0 * values[Correct] / totalAnswered) : 0;
+
+        lblTotal->setText("Total answered: " + QString::number(totalAnswered));
+        lblAccuracy->setText("Accuracy: " + QString::number(acc, 'f', 1) + "%");
+    }
 
-    l->addStretch();
-    return row;
+    struct Row { Counter counter; QLabel *label; const char *prefix; };
+    const Row rows[] = {
+        { HiraCorrect, lblHiraCorrect, "Correct: " },
+        { HiraWrong,   lblHiraWrong,   "Wrong: " },
+        { HiraStreak,  lblHiraStreak,  "Streak: " },
+        { KataCorrect, lblKataCorrect, "Correct: " },
+        { KataWrong,   lblKataWrong,   "Wrong: " },
+        { KataStreak,  lblKataStreak,  "Streak: " },
+    };
+
+    for (const Row &r : rows)
+        if (values[r.counter] != m_shown[r.counter])
+            r.label->setText(r.prefix + QString::number(values[r.counter]));
+
+    std::copy(std::begin(values), std::end(values), std::begin(m_shown));
+
+    // Ranking the slowest symbols merges every symbol's histograms; not
+    // worth doing per answer behind the practice page. loadStats() does it.
+    if (isVisible())
+    {
+        updateLatency(true);
+        updateLatency(false);
+    }
 }
 
-QWidget* StatisticsPage::createMasteredCard(const QString& kana, const QString& romaji)
+// Response-time percentiles; only redone when a new timed answer arrived
+// since the labels were last filled
+void StatisticsPage::updateLatency(bool hira)
 {
-    auto *w = new QWidget();
-    auto *v = new QVBoxLayout(w);
+    const LatencyHistogram &h = progress->scriptLatency(hira);
+    quint64 &shown = m_latencyShown[hira ? 0 : 1];
+    if (h.count() == shown)
+        return;
+    shown = h.count();
 
-    auto *k = new QLabel(kana);
-    k->setAlignment(Qt::AlignCenter);
-    k->setStyleSheet("font-size:26pt; color:white;");
+    QLabel *speed   = hira ? lblHiraSpeed : lblKataSpeed;
+    QLabel *slowest = hira ? lblHiraSlowest : lblKataSlowest;
 
-    auto *r = new QLabel(romaji);
-    r->setAlignment(Qt::AlignCenter);
-    r->setStyleSheet("font-size:10pt; color:#bbbbbb;");
+    if (h.isEmpty())
+    {
+        speed->setText("Response time: —");
+        slowest->setText("Slowest (p90): —");
+        return;
+    }
 
-    v->addWidget(k);
-    v->addWidget(r);
+    speed->setText(QString("Response time: p50 %1 ms · p90 %2 ms")
+                       .arg(h.percentile(50))
+                       .arg(h.percentile(90)));
 
-    w->setStyleSheet(
-        "background:#2b2b2b;"
-        "border-radius:12px;"
-        "padding:8px;"
-        );
-    return w;
+    QStringList kana;
+    for (int id : progress->slowestSymbols(hira, 5))
+        kana.append(KanaCatalog::kana(id, hira) + " " +
+                    QString::number(progress->latency(hira, id).percentile(90)) + " ms");
+    slowest->setText("Slowest (p90): " + (kana.isEmpty() ? QString("—") : kana.join(", ")));
 }
 
-// Romaji to Kana
-QString StatisticsPage::kanaFromRomaji(const QString& r, bool hira)
+// One symbol changed: only its card (and the ones after it) move
+void StatisticsPage::updateSymbol(bool hira, int id)
 {
-    static const QMap<QString, QString> H = {
-                                             // Hiragana
-                                             {"a","あ"},{"i","い"},{"u","う"},{"e","え"},{"o","お"},
-                                             {"ka","か"},{"ki","き"},{"ku","く"},{"ke","け"},{"ko","こ"},
-                                             {"sa","さ"},{"shi","し"},{"su","す"},{"se","せ"},{"so","そ"},
-                                             {"ta","た"},{"chi","ち"},{"tsu","つ"},{"te","て"},{"to","と"},
-                                             {"na","な"},{"ni","に"},{"nu","ぬ"},{"ne","ね"},{"no","の"},
-                                             {"ha","は"},{"hi","ひ"},{"fu","ふ"},{"he","へ"},{"ho","ほ"},
-                                             {"ma","ま"},{"mi","み"},{"mu","む"},{"me","め"},{"mo","も"},
-                                             {"ya","や"},{"yu","ゆ"},{"yo","よ"},
-                                             {"ra","ら"},{"ri","り"},{"ru","る"},{"re","れ"},{"ro","ろ"},
-                                             {"wa","わ"},{"wo","を"},{"n","ん"},
-
-                                             {"ga","が"},{"gi","ぎ"},{"gu","ぐ"},{"ge","げ"},{"go","ご"},
-                                             {"za","ざ"},{"ji","じ"},{"zu","ず"},{"ze","ぜ"},{"zo","ぞ"},
-                                             {"da","だ"},{"ji(di)","ぢ"},{"zu(du)","づ"},{"de","で"},{"do","ど"},
-
-                                             {"ba","ば"},{"bi","び"},{"bu","ぶ"},{"be","べ"},{"bo","ぼ"},
-                                             {"pa","ぱ"},{"pi","ぴ"},{"pu","ぷ"},{"pe","ぺ"},{"po","ぽ"},
-
-                                             {"kya","きゃ"},{"kyu","きゅ"},{"kyo","きょ"},
-                                             {"gya","ぎゃ"},{"gyu","ぎゅ"},{"gyo","ぎょ"},
-                                             {"sha","しゃ"},{"shu","しゅ"},{"sho","しょ"},
-                                             {"ja","じゃ"},{"ju","じゅ"},{"jo","じょ"},
-                                             {"cha","ちゃ"},{"chu","ちゅ"},{"cho","ちょ"},
-                                             {"ja(chi)","ぢゃ"},{"ju(chi)","ぢゅ"},{"jo(chi)","ぢょ"},
-                                             {"nya","にゃ"},{"nyu","にゅ"},{"nyo","にょ"},
-                                             {"hya","ひゃ"},{"hyu","ひゅ"},{"hyo","ひょ"},
-                                             {"mya","みゃ"},{"myu","みゅ"},{"myo","みょ"},
-                                             {"rya","りゃ"},{"ryu","りゅ"},{"ryo","りょ"},
-                                             };
-
-    static const QMap<QString, QString> K = {
-                                             // Katakana
-                                             {"a","ア"},{"i","イ"},{"u","ウ"},{"e","エ"},{"o","オ"},
-                                             {"ka","カ"},{"ki","キ"},{"ku","ク"},{"ke","ケ"},{"ko","コ"},
-                                             {"sa","サ"},{"shi","シ"},{"su","ス"},{"se","セ"},{"so","ソ"},
-                                             {"ta","タ"},{"chi","チ"},{"tsu","ツ"},{"te","テ"},{"to","ト"},
-                                             {"na","ナ"},{"ni","ニ"},{"nu","ヌ"},{"ne","ネ"},{"no","ノ"},
-                                             {"ha","ハ"},{"hi","ヒ"},{"fu","フ"},{"he","ヘ"},{"ho","ホ"},
-                                             {"ma","マ"},{"mi","ミ"},{"mu","ム"},{"me","メ"},{"mo","モ"},
-                                             {"ya","ヤ"},{"yu","ユ"},{"yo","ヨ"},
-                                             {"ra","ラ"},{"ri","リ"},{"ru","ル"},{"re","レ"},{"ro","ロ"},
-                                             {"wa","ワ"},{"wo","ヲ"},{"n","ン"},
-
-                                             {"ga","ガ"},{"gi","ギ"},{"gu","グ"},{"ge","ゲ"},{"go","ゴ"},
-                                             {"za","ザ"},{"ji","ジ"},{"zu","ズ"},{"ze","ゼ"},{"zo","ゾ"},
-                                             {"da","ダ"},{"ji(di)","ヂ"},{"zu(du)","ヅ"},{"de","デ"},{"do","ド"},
-
-                                             {"ba","バ"},{"bi","ビ"},{"bu","ブ"},{"be","ベ"},{"bo","ボ"},
-                                             {"pa","パ"},{"pi","ピ"},{"pu","プ"},{"pe","ペ"},{"po","ポ"},
-
-                                             {"kya","キャ"},{"kyu","キュ"},{"kyo","キョ"},
-                                             {"gya","ギャ"},{"gyu","ギュ"},{"gyo","ギョ"},
-                                             {"sha","シャ"},{"shu","シュ"},{"sho","ショ"},
-                                             {"ja","ジャ"},{"ju","ジュ"},{"jo","ジョ"},
-                                             {"cha","チャ"},{"chu","チュ"},{"cho","チョ"},
-                                             {"ja(chi)","ヂャ"},{"ju(chi)","ヂュ"},{"jo(chi)","ヂョ"},
-                                             {"nya","ニャ"},{"nyu","ニュ"},{"nyo","ニョ"},
-                                             {"hya","ヒャ"},{"hyu","ヒュ"},{"hyo","ヒョ"},
-                                             {"mya","ミャ"},{"myu","ミュ"},{"myo","ミョ"},
-                                             {"rya","リャ"},{"ryu","リュ"},{"ryo","リョ"},
-                                             };
-
-    return hira ? H.value(r, r) : K.value(r, r);
-}
+    KANA_TRACE_SCOPE("StatisticsPage::updateSymbol");
 
+    const bool mastered = progress->isMastered(hira, id);
+    (hira ? hiraMastered : kataMastered)->setSymbolMastered(id, mastered);
+
+    if (mastered)
+        m_masteredSet.insert(hira, id);
+    else
+        m_masteredSet.remove(hira, id);
+    wordService->setMasteredFilter(m_masteredSet);
+}
@@ -3,18 +3,23 @@
 
 #include <QWidget>
 
+#include "worddictionary.h"
+
 class QLabel;
 class QPushButton;
+class QLineEdit;
 class QVBoxLayout;
 class QHBoxLayout;
 class WordApiService;
+class ProgressManager;
+class MasteredView;
 
 class StatisticsPage : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit StatisticsPage(QWidget *parent = nullptr);
+    explicit StatisticsPage(ProgressManager *progress, QWidget *parent = nullptr);
     void loadStats();
 
 signals:
@@ -22,11 +27,9 @@ signals:
 
 private:
     void buildUi();
-
-    // Helpers
-    QWidget* createMasteredRow(const QStringList& romajiList, bool hiragana);
-    QWidget* createMasteredCard(const QString& kana, const QString& romaji);
-    QString  kanaFromRomaji(const QString& romaji, bool hiragana);
+    void updateTotals();
+    void updateSymbol(bool hiragana, int id);
+    void updateLatency(bool hiragana);
 
 private:
     QVBoxLayout *rootLayout = nullptr;
@@ -39,13 +42,17 @@ private:
     QLabel *lblHiraCorrect;
     QLabel *lblHiraWrong;
     QLabel *lblHiraStreak;
-    QWidget *hiraMasteredWidget;
+    QLabel *lblHiraSpeed;
+    QLabel *lblHiraSlowest;
+    MasteredView *hiraMastered;
 
     // Katakana
     QLabel *lblKataCorrect;
     QLabel *lblKataWrong;
     QLabel *lblKataStreak;
-    QWidget *kataMasteredWidget;
+    QLabel *lblKataSpeed;
+    QLabel *lblKataSlowest;
+    MasteredView *kataMastered;
 
     // API
     QLabel *lblWordKana;
@@ -53,9 +60,21 @@ private:
     QLabel *lblWordMeaning;
     WordApiService *wordService;
     QPushButton *btnNewWord;
+    QPushButton *btnMasteredOnly;
+    QLabel *lblFilterNote;
+    QLineEdit *editSearch;
     QWidget *wordCard;
 
     QPushButton *btnHome;
+
+    ProgressManager *progress;
+
+    // What the labels show, so unchanged counters are skipped
+    enum Counter { Total, Correct, HiraCorrect, HiraWrong, HiraStreak,
+                   KataCorrect, KataWrong, KataStreak, CounterCount };
+    int m_shown[CounterCount];
+    quint64 m_latencyShown[2] = { quint64(-1), quint64(-1) };   // answers timed, per script
+    KanaSet m_masteredSet;
 };
 
 #endif
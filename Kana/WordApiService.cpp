@@ -6,47 +6,375 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QUrl>
+#include <QUrlQuery>
 #include <QRandomGenerator>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QDebug>
+
+#include <algorithm>
+
+#include "worddictionary.h"
+#include "trace.h"
+
+// Search text is also a cache file name
+static const int MAX_SEARCH_LENGTH = 32;
+static const int MAX_SEARCH_HITS   = 20;
+
+namespace
+{
+    // Pool for searching
+    const QStringList &seeds()
+    {
+        static const QStringList s = {
+            "あ","い","う","か","さ","た","な",
+            "日","人","水","山","火"
+        };
+        return s;
+    }
+}
 
 WordApiService::WordApiService(QObject *parent)
     : QObject(parent)
 {
     net = new QNetworkAccessManager(this);
+
+    const QString url = qEnvironmentVariable("KANA_WORD_API_URL");
+    m_baseUrl = QUrl(url.isEmpty() ? QStringLiteral("https://jisho.org/api/v1/search/words")
+                                   : url);
+
+    // Per-user cache, independent of the launch directory; next to the
+    // executable (like the asset pack) when the platform has none
+    QString cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cache.isEmpty())
+        cache = QCoreApplication::applicationDirPath() + "/data";
+    m_cacheDir = cache + "/word_cache";
+}
+
+void WordApiService::setMasteredFilter(const KanaSet &mastered)
+{
+    m_mastered = mastered;
+}
+
+void WordApiService::setMasteredOnly(bool on)
+{
+    m_masteredOnly = on;
 }
 
 void WordApiService::fetchWord()
 {
-    // Pool for searching
-    static QStringList seeds = {
-        "あ","い","う","か","さ","た","な",
-        "日","人","水","山","火"
-    };
+    // Back to the seed keywords after a search
+    if (m_searching && !m_waiting)
+    {
+        m_searching = false;
+        m_currentSeed.clear();
+    }
+
+    // The latest click wins over a search still queued
+    m_pendingSearch.clear();
+
+    if (!m_offline || !fetchOffline())
+        fetchOnline();
+}
+
+void WordApiService::searchWord(const QString &text)
+{
+    const QString query = text.trimmed().left(MAX_SEARCH_LENGTH);
+    if (query.isEmpty())
+        return;
+
+    // The dictionary answers at once; a reply still out then only fills
+    // the cache
+    if (m_offline && searchOffline(query))
+    {
+        m_searching = true;
+        m_waiting = false;
+        m_pendingSearch.clear();
+        return;
+    }
+
+    // Asked again once the reply that is out has been handled, so the
+    // page is not answered with that reply's word
+    if (m_waiting)
+    {
+        m_pendingSearch = query;
+        return;
+    }
+
+    m_searching = true;
+    m_currentSeed = query;
+    Page *page = cachedPage(query);
+    if (page && serveFrom(*page))
+        return;
+
+    m_waiting = true;
+    request(query);
+}
+
+bool WordApiService::searchOffline(const QString &text)
+{
+    KANA_TRACE_SCOPE("WordApiService::searchOffline");
+
+    const WordDictionary *dict = WordDictionary::instance();
+    if (!dict->isOpen())
+        return false;
+
+    const bool latin = std::all_of(text.begin(), text.end(),
+                                   [](QChar c) { return c.unicode() < 0x80; });
+    const QVector<int> hits = latin ? dict->findByRomaji(text, MAX_SEARCH_HITS)
+                                    : dict->findByKana(text, MAX_SEARCH_HITS);
+    if (hits.isEmpty())
+        return false;
+
+    // Searching again shows another match
+    int index = hits[QRandomGenerator::global()->bounded(hits.size())];
+    if (index == m_lastIndex && hits.size() > 1)
+        index = hits[(hits.indexOf(index) + 1) % hits.size()];
+
+    m_filterFellBack = false;
+    emitWord(index);
+    return true;
+}
+
+bool WordApiService::fetchOffline()
+{
+    KANA_TRACE_SCOPE("WordApiService::fetchOffline");
+
+    const WordDictionary *dict = WordDictionary::instance();
+    if (!dict->isOpen())
+        return false;
+
+    int index = -1;
+    if (m_masteredOnly && !m_mastered.isEmpty())
+        index = dict->randomWord(&m_mastered, m_lastIndex);
+
+    // Nothing spelled only with mastered kana yet: any word will do, and
+    // the page says so
+    const bool fellBack = m_masteredOnly && index < 0;
+    if (index < 0)
+        index = dict->randomWord(nullptr, m_lastIndex);
+    if (index < 0)
+        return false;
+
+    m_filterFellBack = fellBack;
+    emitWord(index);
+    return true;
+}
+
+void WordApiService::emitWord(int index)
+{
+    m_lastIndex = index;
+
+    const WordDictionary::Word w = WordDictionary::instance()->word(index);
+    QString romaji = w.romaji;
+    if (w.written != w.reading)
+        romaji += " (" + w.written + ")";
+
+    emit wordReady(w.reading, romaji, w.meaning);
+}
+
+// Online
+
+void WordApiService::fetchOnline()
+{
+    // A request is already out for the current seed; its reply answers
+    // this click too
+    if (m_waiting)
+        return;
+
+    // Keep handing out the current page until it is used up
+    if (!m_currentSeed.isEmpty())
+    {
+        Page *page = cachedPage(m_currentSeed);
+        if (page && serveFrom(*page))
+            return;
+    }
+
+    // Another seed; prefer one that is already cached
+    QStringList candidates = seeds();
+    candidates.removeAll(m_currentSeed);
 
-    QString seed = seeds[
-        QRandomGenerator::global()->bounded(seeds.size())
-    ];
+    std::shuffle(candidates.begin(), candidates.end(), *QRandomGenerator::global());
 
-    QUrl url("https://jisho.org/api/v1/search/words?keyword=" + seed);
+    QString seed = candidates.first();
+    for (const QString &s : candidates)
+    {
+        Page *page = cachedPage(s);
+        if (page && page->cursor < page->data.size())
+        {
+            seed = s;
+            break;
+        }
+    }
 
-    QNetworkRequest req(url);
+    m_currentSeed = seed;
 
-    auto *reply = net->get(req);
+    Page *page = cachedPage(seed);
+    if (page && serveFrom(*page))
+        return;
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+    // Rapid clicks while a request is out collapse into one answer
+    m_waiting = true;
+    request(seed);
+}
+
+bool WordApiService::isFresh(const Page &page) const
+{
+    const qint64 age = QDateTime::currentMSecsSinceEpoch() - page.fetchedMs;
+    return age >= 0 && age < m_ttlSecs * 1000;
+}
+
+// Memory first, then disk. nullptr when missing or stale.
+WordApiService::Page *WordApiService::cachedPage(const QString &seed)
+{
+    KANA_TRACE_SCOPE("WordApiService::cachedPage");
+
+    auto it = m_pages.find(seed);
+    if (it != m_pages.end())
+    {
+        if (isFresh(*it))
+            return &*it;
+        m_pages.erase(it);
+        return nullptr;
+    }
+
+    QFile f(cachePath(seed));
+    if (!f.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const QJsonObject obj = QJsonDocument::fromJson(f.readAll()).object();
+    const qint64 fetched = qint64(obj["fetched"].toDouble());
+    const QJsonArray data = obj["data"].toArray();
+
+    Page page;
+    page.fetchedMs = fetched;
+    if (data.isEmpty() || !isFresh(page))
+        return nullptr;
+
+    storePage(seed, data, fetched);
+    return &m_pages[seed];
+}
+
+QString WordApiService::cachePath(const QString &seed) const
+{
+    return m_cacheDir + "/" + QString::fromLatin1(seed.toUtf8().toHex()) + ".json";
+}
+
+void WordApiService::storePage(const QString &seed, const QJsonArray &data, qint64 fetchedMs)
+{
+    Page page;
+    page.data = data;
+    page.fetchedMs = fetchedMs;
+
+    page.order.resize(data.size());
+    for (int i = 0; i < page.order.size(); ++i)
+        page.order[i] = i;
+    std::shuffle(page.order.begin(), page.order.end(), *QRandomGenerator::global());
+
+    m_pages.insert(seed, page);
+}
+
+void WordApiService::request(const QString &seed)
+{
+    if (m_inFlight.contains(seed))
+        return;
+
+    QUrl url(m_baseUrl);
+    QUrlQuery query;
+    query.addQueryItem("keyword", seed);
+    url.setQuery(query);
+
+    auto *reply = net->get(QNetworkRequest(url));
+    m_inFlight.insert(seed, reply);
+    ++m_networkRequests;
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, seed]() {
         reply->deleteLater();
+        m_inFlight.remove(seed);
+
+        KANA_TRACE_SCOPE("WordApiService::parseReply");
 
         if (reply->error() != QNetworkReply::NoError)
+        {
+            qDebug() << "Word search failed:" << reply->errorString();
+            replyFailed(seed);
             return;
+        }
 
         auto doc = QJsonDocument::fromJson(reply->readAll());
-        auto root = doc.object();
-        auto data = root["data"].toArray();
+        auto data = doc.object()["data"].toArray();
         if (data.isEmpty())
+        {
+            replyFailed(seed);
             return;
+        }
+
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        storePage(seed, data, now);
+
+        QJsonObject cached;
+        cached["fetched"] = double(now);
+        cached["data"] = data;
+
+        QDir().mkpath(m_cacheDir);
+        QSaveFile out(cachePath(seed));
+        if (out.open(QIODevice::WriteOnly))
+        {
+            out.write(QJsonDocument(cached).toJson(QJsonDocument::Compact));
+            if (!out.commit())
+                qDebug() << "Cannot write word cache" << out.fileName();
+        }
+
+        if (m_waiting)
+        {
+            m_waiting = false;
+            if (!m_pendingSearch.isEmpty())
+            {
+                runPendingSearch();
+                return;
+            }
+            m_currentSeed = seed;
+            serveFrom(m_pages[seed]);
+        }
+    });
+}
+
+// The reply a click was waiting for brought nothing
+void WordApiService::replyFailed(const QString &seed)
+{
+    if (!m_waiting)
+        return;
+
+    m_waiting = false;
+    if (!m_pendingSearch.isEmpty())
+        runPendingSearch();
+    else if (m_searching)
+        emit noWordFound(seed);
+}
+
+void WordApiService::runPendingSearch()
+{
+    const QString query = m_pendingSearch;
+    m_pendingSearch.clear();
+    searchWord(query);
+}
+
+// Next unseen entry of the page; false once it is used up
+bool WordApiService::serveFrom(Page &page)
+{
+    KANA_TRACE_SCOPE("WordApiService::serveFrom");
+
+    while (page.cursor < page.order.size())
+    {
+        auto entry = page.data[page.order[page.cursor++]].toObject();
+        QString id = entry["slug"].toString();
+        if (id == lastWordId)
+            continue;
 
-        auto entry = data[
-                         QRandomGenerator::global()->bounded(data.size())
-        ].toObject();
         auto jp = entry["japanese"].toArray().first().toObject();
         auto sense = entry["senses"].toArray().first().toObject();
 
@@ -56,12 +384,13 @@ void WordApiService::fetchWord()
         for (const auto& v : sense["english_definitions"].toArray())
             meanings << v.toString();
 
-        QString meaning = meanings.join(", ");
-        QString id = entry["slug"].toString();
-        if (id == lastWordId)
-            return;
-
         lastWordId = id;
-        emit wordReady(kana, romaji, meaning);
-    });
+        m_filterFellBack = m_masteredOnly && !m_searching;   // network words are not filtered
+        emit wordReady(kana, romaji, meanings.join(", "));
+        return true;
+    }
+
+    // Used up: start over next time this page is picked
+    page.cursor = 0;
+    return false;
 }
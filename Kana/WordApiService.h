@@ -2,9 +2,25 @@
 #define WORDAPISERVICE_H
 
 #include <QObject>
+#include <QHash>
+#include <QJsonArray>
+#include <QUrl>
+#include <QVector>
+
+#include "worddictionary.h"
 
 class QNetworkAccessManager;
+class QNetworkReply;
 
+// Word of the day. Served from the bundled offline dictionary when it is
+// present; jisho.org is only asked when there is no dictionary (or nothing
+// in it matches).
+//
+// Online search pages are cached per seed keyword, in memory and under
+// cacheDir() (the platform cache location by default), for cacheTtl()
+// seconds; the words of a page are handed out one by one before another
+// seed is fetched. Only one request per seed is ever in flight, and rapid
+// fetchWord() calls collapse into one answer.
 class WordApiService : public QObject
 {
     Q_OBJECT
@@ -12,14 +28,85 @@ public:
     explicit WordApiService(QObject *parent = nullptr);
     void fetchWord();
 
+    // A word starting with `text` (kana or romaji): the dictionary's prefix
+    // indexes first, the search endpoint when nothing matches offline. A
+    // search made while a reply is out runs once that reply is in.
+    void searchWord(const QString &text);
+
+    // Restrict offline words to ones spelled with these kana
+    void setMasteredFilter(const KanaSet &mastered);
+    void setMasteredOnly(bool on);
+    bool masteredOnly() const { return m_masteredOnly; }
+
+    // The last word ignores setMasteredOnly(): no word is spelled with the
+    // mastered kana alone yet, or it came from the network
+    bool filterFellBack() const { return m_filterFellBack; }
+
+    // Search endpoint; KANA_WORD_API_URL overrides the default, so a local
+    // stand-in server can be used
+    void setBaseUrl(const QUrl &url) { m_baseUrl = url; }
+    QUrl baseUrl() const { return m_baseUrl; }
+
+    void setCacheDir(const QString &dir) { m_cacheDir = dir; }
+    QString cacheDir() const { return m_cacheDir; }
+    void setCacheTtl(qint64 seconds) { m_ttlSecs = seconds; }
+    qint64 cacheTtl() const { return m_ttlSecs; }
+
+    // Offline dictionary on/off (the network path is used when off)
+    void setOfflineEnabled(bool on) { m_offline = on; }
+
+    int networkRequests() const { return m_networkRequests; }
+
 signals:
     void wordReady(const QString& kana,
                    const QString& romaji,
                    const QString& meaning);
+    // searchWord() found nothing, offline or online
+    void noWordFound(const QString &text);
 
 private:
+    struct Page
+    {
+        QJsonArray   data;
+        qint64       fetchedMs = 0;
+        QVector<int> order;        // shuffled entry numbers
+        int          cursor = 0;   // next entry in `order`
+    };
+
+    bool fetchOffline();
+    void fetchOnline();
+    bool searchOffline(const QString &text);
+    void emitWord(int index);
+
+    bool isFresh(const Page &page) const;
+    Page *cachedPage(const QString &seed);
+    QString cachePath(const QString &seed) const;
+    void storePage(const QString &seed, const QJsonArray &data, qint64 fetchedMs);
+    void request(const QString &seed);
+    bool serveFrom(Page &page);
+    void replyFailed(const QString &seed);
+    void runPendingSearch();
+
     QNetworkAccessManager *net;
     QString lastWordId;
+
+    KanaSet m_mastered;
+    bool    m_masteredOnly = false;
+    bool    m_filterFellBack = false;
+    bool    m_searching = false;       // the current page is a searchWord() result
+    bool    m_offline = true;
+    int     m_lastIndex = -1;
+
+    QUrl    m_baseUrl;
+    QString m_cacheDir;
+    qint64  m_ttlSecs = 7 * 24 * 3600;
+
+    QHash<QString, Page>           m_pages;
+    QHash<QString, QNetworkReply*> m_inFlight;
+    QString m_currentSeed;
+    bool    m_waiting = false;     // a fetchWord() is waiting for the network
+    QString m_pendingSearch;       // searchWord() made while waiting
+    int     m_networkRequests = 0;
 };
 
 #endif
@@ -0,0 +1,289 @@
+#include "answerhistory.h"
+#include "kanacatalog.h"
+#include "trace.h"
+
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+static const char    HISTORY_MAGIC[4] = { 'K', 'H', 'I', 'S' };
+static const quint16 HISTORY_VERSION  = 1;
+static const quint8  NO_CHOICE        = 127;
+
+// Symbol byte: bit 7 script, bits 0-6 id; outcome byte: 127 = no choice
+static_assert(KanaCatalog::Count < NO_CHOICE,
+              "catalog ids no longer fit the 7-bit history encoding");
+
+namespace
+{
+    void putVarint(QByteArray &out, quint64 v)
+    {
+        while (v >= 0x80)
+        {
+            out.append(char(v | 0x80));
+            v >>= 7;
+        }
+        out.append(char(v));
+    }
+
+    bool getVarint(const uchar *&p, const uchar *end, quint64 *v)
+    {
+        quint64 result = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7)
+        {
+            const uchar b = *p++;
+            result |= quint64(b & 0x7F) << shift;
+            if (!(b & 0x80))
+            {
+                *v = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    quint64 zigzag(qint64 v)   { return (quint64(v) << 1) ^ quint64(v >> 63); }
+    qint64  unzigzag(quint64 v) { return qint64(v >> 1) ^ -qint64(v & 1); }
+
+    // Local calendar day, cached across calls since events arrive in order
+    qint64 julianDay(qint64 when)
+    {
+        static qint64 dayStart = 0, dayEnd = 0, day = 0;
+        if (when < dayStart || when >= dayEnd)
+        {
+            const QDate d = QDateTime::fromSecsSinceEpoch(when).date();
+            dayStart = QDateTime(d, QTime(0, 0)).toSecsSinceEpoch();
+            dayEnd   = QDateTime(d.addDays(1), QTime(0, 0)).toSecsSinceEpoch();
+            day      = d.toJulianDay();
+        }
+        return day;
+    }
+}
+
+
+// Recording
+void AnswerHistory::append(qint64 when, bool isHiragana, int id, bool correct, int chosenId,
+                           Direction direction, int responseMs, qint64 seq)
+{
+    if (!KanaCatalog::isValid(id))
+        return;
+
+    const quint8 chosen = KanaCatalog::isValid(chosenId) && chosenId != id
+                              ? quint8(chosenId) : NO_CHOICE;
+
+    add(when,
+        quint8(symbolKey(isHiragana, id)),
+        quint8((correct ? 0x80 : 0) | chosen),
+        quint8(direction),
+        responseMs >= 0 ? quint32(responseMs) + 1 : 0);
+
+    m_lastSeq = qMax(m_lastSeq, seq);
+}
+
+void AnswerHistory::add(qint64 when, quint8 symbol, quint8 outcome, quint8 direction,
+                        quint32 response)
+{
+    const int index = m_time.size();
+
+    m_time.append(when);
+    m_symbol.append(symbol);
+    m_outcome.append(outcome);
+    m_direction.append(direction);
+    m_response.append(response);
+    m_bySymbol[symbol].append(index);
+
+    DayRollup &d = m_days[julianDay(when)];
+    d.answered++;
+    if (outcome & 0x80)
+        d.correct++;
+    if (response)
+    {
+        d.timed++;
+        d.responseMsSum += response - 1;
+    }
+}
+
+
+// Queries
+QVector<AnswerHistory::DayStats> AnswerHistory::accuracyByDay(const QDate &from,
+                                                              const QDate &to) const
+{
+    QVector<DayStats> out;
+
+    const qint64 last = to.toJulianDay();
+    for (auto it = m_days.lowerBound(from.toJulianDay());
+         it != m_days.cend() && it.key() <= last; ++it)
+    {
+        DayStats s;
+        s.day      = QDate::fromJulianDay(it.key());
+        s.answered = it->answered;
+        s.correct  = it->correct;
+        if (it->timed)
+            s.avgResponseMs = int(it->responseMsSum / it->timed);
+        out.append(s);
+    }
+    return out;
+}
+
+AnswerHistory::Retention AnswerHistory::retention(bool isHiragana, int id,
+                                                  qint64 minGapSecs) const
+{
+    Retention r;
+    if (!KanaCatalog::isValid(id))
+        return r;
+
+    const QVector<int> &events = m_bySymbol[symbolKey(isHiragana, id)];
+    for (int i = 1; i < events.size(); ++i)
+    {
+        if (m_time[events[i]] - m_time[events[i - 1]] < minGapSecs)
+            continue;
+
+        r.attempts++;
+        if (m_outcome[events[i]] & 0x80)
+            r.recalled++;
+    }
+    return r;
+}
+
+
+// Encoding
+QByteArray AnswerHistory::takeUnflushed()
+{
+    const int first = m_flushed;
+    const int count = m_time.size() - first;
+    if (count <= 0)
+        return QByteArray();
+
+    QByteArray payload;
+    payload.reserve(count * 6);
+
+    qint64 prev = m_time[first];
+    for (int i = first; i < first + count; ++i)
+    {
+        putVarint(payload, zigzag(m_time[i] - prev));
+        prev = m_time[i];
+    }
+
+    payload.append(reinterpret_cast<const char *>(m_symbol.constData() + first), count);
+    payload.append(reinterpret_cast<const char *>(m_outcome.constData() + first), count);
+
+    QByteArray directions((count + 3) / 4, '\0');
+    for (int i = 0; i < count; ++i)
+        directions[i / 4] = char(directions[i / 4] | ((m_direction[first + i] & 3) << (2 * (i % 4))));
+    payload.append(directions);
+
+    for (int i = first; i < first + count; ++i)
+        putVarint(payload, m_response[i]);
+
+    Header h;
+    std::memcpy(h.magic, HISTORY_MAGIC, 4);
+    h.version     = qToLittleEndian(HISTORY_VERSION);
+    h.checksum    = qToLittleEndian(qChecksum(payload));
+    h.count       = qToLittleEndian(quint32(count));
+    h.payloadSize = qToLittleEndian(quint32(payload.size()));
+    h.fingerprint = qToLittleEndian(KanaCatalog::fingerprint());
+    h.reserved    = 0;
+    h.baseTime    = qToLittleEndian(m_time[first]);
+    h.lastSeq     = qToLittleEndian(m_lastSeq);
+
+    m_flushed = m_time.size();
+    return QByteArray(reinterpret_cast<const char *>(&h), sizeof(h)) + payload;
+}
+
+
+// Decoding
+int AnswerHistory::load(const QByteArray &bytes)
+{
+    KANA_TRACE_SCOPE("AnswerHistory::load");
+
+    int pos = 0;
+    while (pos < bytes.size())
+    {
+        int used = 0;
+        if (!decodeBlock(bytes.constData() + pos, bytes.size() - pos, &used))
+        {
+            qDebug() << "Answer history damaged at byte" << pos << "- dropping the rest";
+            break;
+        }
+        pos += used;
+    }
+
+    m_flushed = m_time.size();
+    return pos;
+}
+
+bool AnswerHistory::decodeBlock(const char *data, int size, int *used)
+{
+    if (size < int(sizeof(Header)))
+        return false;
+
+    Header h;
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, HISTORY_MAGIC, 4) != 0 ||
+        qFromLittleEndian(h.version) != HISTORY_VERSION)
+        return false;
+
+    const quint32 count       = qFromLittleEndian(h.count);
+    const quint32 payloadSize = qFromLittleEndian(h.payloadSize);
+    if (payloadSize > quint32(size) - sizeof(Header))
+        return false;
+
+    // Every event takes at least one payload byte; a larger count is a
+    // damaged header and must not size the allocations below
+    if (count > payloadSize)
+        return false;
+
+    const char *payload = data + sizeof(Header);
+    if (qChecksum(QByteArrayView(payload, payloadSize)) != qFromLittleEndian(h.checksum))
+        return false;
+
+    *used = int(sizeof(Header) + payloadSize);
+
+    // Ids from another catalog would point at the wrong symbols
+    if (qFromLittleEndian(h.fingerprint) != KanaCatalog::fingerprint())
+    {
+        qDebug() << "Skipping answer history block from another kana catalog";
+        return true;
+    }
+
+    const uchar *p   = reinterpret_cast<const uchar *>(payload);
+    const uchar *end = p + payloadSize;
+
+    QVector<qint64> times(int(count));
+    qint64 t = qFromLittleEndian(h.baseTime);
+    for (quint32 i = 0; i < count; ++i)
+    {
+        quint64 v;
+        if (!getVarint(p, end, &v))
+            return false;
+        t += unzigzag(v);
+        times[i] = t;
+    }
+
+    const quint32 directionBytes = (count + 3) / 4;
+    if (quint32(end - p) < 2 * count + directionBytes)
+        return false;
+
+    const uchar *symbols    = p;
+    const uchar *outcomes   = symbols + count;
+    const uchar *directions = outcomes + count;
+    p = directions + directionBytes;
+
+    QVector<quint32> responses(int(count));
+    for (quint32 i = 0; i < count; ++i)
+    {
+        quint64 v;
+        if (!getVarint(p, end, &v))
+            return false;
+        responses[i] = quint32(v);
+    }
+
+    // Whole block decoded; only now does it become visible
+    for (quint32 i = 0; i < count; ++i)
+        add(times[i], symbols[i], outcomes[i],
+            quint8((directions[i / 4] >> (2 * (i % 4))) & 3), responses[i]);
+
+    m_lastSeq = qMax(m_lastSeq, qint64(qFromLittleEndian(h.lastSeq)));
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef ANSWERHISTORY_H
+#define ANSWERHISTORY_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QMap>
+#include <QVector>
+#include <QtGlobal>
+
+// Every answer ever given, for learning curves and retention.
+//
+// In memory the events are kept column by column and indexed per symbol;
+// per-day rollups are maintained on append, so the queries below never
+// scan more than the days or the symbol's own answers.
+//
+// On disk (data/answer_history.bin) the log is a sequence of append-only
+// blocks, little endian:
+//   Header   magic "KHIS", version, CRC-16 of the payload, event count,
+//            payload size, catalog fingerprint, first timestamp, last
+//            journal sequence number
+//   Payload  time      zigzag varint delta to the previous event (seconds)
+//            symbol    1 byte: bit 7 katakana, bits 0-6 catalog id
+//            outcome   1 byte: bit 7 correct, bits 0-6 chosen id (127 = none)
+//            direction 2 bits per event
+//            response  varint, milliseconds + 1 (0 = not measured)
+// A typical answer costs about five bytes.
+class AnswerHistory
+{
+public:
+    enum class Direction : quint8 { KanaToRomaji, RomajiToKana, AudioToKana };
+
+    struct DayStats
+    {
+        QDate day;
+        int answered = 0;
+        int correct  = 0;
+        int avgResponseMs = -1;    // -1 when no answer that day was timed
+    };
+
+    struct Retention
+    {
+        int attempts = 0;    // answers given at least minGap after the previous one
+        int recalled = 0;    // ... of which correct
+    };
+
+    void append(qint64 when, bool isHiragana, int id, bool correct, int chosenId,
+                Direction direction, int responseMs, qint64 seq);
+
+    int    size() const { return m_time.size(); }
+    qint64 lastSeq() const { return m_lastSeq; }
+
+    // Accuracy per local calendar day, both scripts; days without answers are skipped
+    QVector<DayStats> accuracyByDay(const QDate &from, const QDate &to) const;
+
+    // How often a symbol was still known after not seeing it for minGapSecs
+    Retention retention(bool isHiragana, int id, qint64 minGapSecs) const;
+
+    // Persistence: load() returns how many bytes were valid (a torn last
+    // block is dropped); takeUnflushed() encodes new events as one block
+    int load(const QByteArray &bytes);
+    bool hasUnflushed() const { return m_flushed < m_time.size(); }
+    QByteArray takeUnflushed();
+
+private:
+    struct Header
+    {
+        char    magic[4];
+        quint16 version;
+        quint16 checksum;
+        quint32 count;
+        quint32 payloadSize;
+        quint32 fingerprint;
+        quint32 reserved;
+        qint64  baseTime;
+        qint64  lastSeq;
+    };
+
+    struct DayRollup
+    {
+        int    answered = 0;
+        int    correct  = 0;
+        int    timed    = 0;
+        qint64 responseMsSum = 0;
+    };
+
+    static int symbolKey(bool isHiragana, int id) { return (isHiragana ? 0 : 128) | id; }
+
+    void add(qint64 when, quint8 symbol, quint8 outcome, quint8 direction, quint32 response);
+    bool decodeBlock(const char *data, int size, int *used);
+
+    // Columns
+    QVector<qint64>  m_time;
+    QVector<quint8>  m_symbol;
+    QVector<quint8>  m_outcome;
+    QVector<quint8>  m_direction;
+    QVector<quint32> m_response;    // ms + 1, 0 = not measured
+
+    QVector<QVector<int>> m_bySymbol = QVector<QVector<int>>(256);   // symbol byte -> events
+    QMap<qint64, DayRollup> m_days;                                   // Julian day -> rollup
+
+    int    m_flushed = 0;
+    qint64 m_lastSeq = 0;
+};
+
+#endif // ANSWERHISTORY_H
@@ -0,0 +1,170 @@
+#include "assetpack.h"
+#include "kanacatalog.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QVector>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QDebug>
+
+#include <cstddef>
+#include <cstring>
+
+static const char    PACK_MAGIC[4] = { 'K', 'P', 'A', 'K' };
+static const quint32 PACK_VERSION  = 1;
+
+
+AssetPack *AssetPack::instance()
+{
+    static AssetPack *pack = []() {
+        auto *p = new AssetPack();
+        if (!p->open(defaultPath()))
+            qDebug() << "Asset pack not available, using loose files";
+        return p;
+    }();
+    return pack;
+}
+
+QString AssetPack::defaultPath()
+{
+    return QCoreApplication::applicationDirPath() + "/data/kana_assets.pak";
+}
+
+// Reader
+bool AssetPack::open(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    const qint64 tableBytes = qint64(KanaCatalog::Count) * KindCount * sizeof(Slot);
+    if (m_size < qint64(sizeof(Header)) + tableBytes)
+    {
+        qDebug() << "Asset pack truncated:" << path;
+        m_file.close();
+        return false;
+    }
+
+    uchar *base = m_file.map(0, m_size);
+    if (!base)
+    {
+        qDebug() << "Asset pack could not be mapped:" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    auto u32 = [base](int offset) { return qFromLittleEndian<quint32>(base + offset); };
+
+    if (std::memcmp(base, PACK_MAGIC, 4) != 0 ||
+        u32(offsetof(Header, version)) != PACK_VERSION ||
+        u32(offsetof(Header, count)) != quint32(KanaCatalog::Count) ||
+        u32(offsetof(Header, kinds)) != quint32(KindCount) ||
+        u32(offsetof(Header, fingerprint)) != KanaCatalog::fingerprint())
+    {
+        qDebug() << "Asset pack does not match this build:" << path;
+        m_file.unmap(base);
+        m_file.close();
+        return false;
+    }
+
+    m_base  = base;
+    m_table = reinterpret_cast<const Slot *>(base + sizeof(Header));
+    return true;
+}
+
+bool AssetPack::contains(Kind kind, int id) const
+{
+    if (!m_base || !KanaCatalog::isValid(id))
+        return false;
+
+    const Slot &s = m_table[id * KindCount + int(kind)];
+    return qFromLittleEndian(s.size) != 0;
+}
+
+QByteArray AssetPack::data(Kind kind, int id) const
+{
+    if (!m_base || !KanaCatalog::isValid(id))
+        return QByteArray();
+
+    const Slot &s = m_table[id * KindCount + int(kind)];
+    const quint32 offset = qFromLittleEndian(s.offset);
+    const quint32 size   = qFromLittleEndian(s.size);
+
+    if (size == 0 || qint64(offset) + size > m_size)
+        return QByteArray();
+
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(m_base + offset), size);
+}
+
+
+// Writer (build step)
+QString AssetPack::sourcePath(const QString &dataDir, Kind kind, int id)
+{
+    switch (kind)
+    {
+    case Kind::HiraganaStroke:
+        return QString("%1/strokes/hira_%2.jpg").arg(dataDir, KanaCatalog::romaji(id));
+    case Kind::KatakanaStroke:
+        return QString("%1/strokes/kata_%2.jpg").arg(dataDir, KanaCatalog::romaji(id));
+    case Kind::Sound:
+        return QString("%1/sounds/%2.mp3").arg(dataDir, KanaCatalog::displayRomaji(id));
+    }
+    return QString();
+}
+
+bool AssetPack::build(const QString &dataDir, const QString &outPath)
+{
+    QVector<Slot>      table(KanaCatalog::Count * KindCount, Slot{ 0, 0 });
+    QHash<QString, Slot> stored;    // same source file -> same blob
+    QByteArray         blobs;
+
+    const quint32 blobBase = quint32(sizeof(Header) + table.size() * sizeof(Slot));
+
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+    {
+        for (int k = 0; k < KindCount; ++k)
+        {
+            const QString path = sourcePath(dataDir, Kind(k), id);
+
+            auto it = stored.constFind(path);
+            if (it == stored.constEnd())
+            {
+                QFile f(path);
+                if (!f.open(QIODevice::ReadOnly))
+                {
+                    qDebug() << "Asset missing:" << path;
+                    continue;
+                }
+
+                const QByteArray bytes = f.readAll();
+                it = stored.insert(path, Slot{ blobBase + quint32(blobs.size()),
+                                               quint32(bytes.size()) });
+                blobs.append(bytes);
+            }
+
+            table[id * KindCount + k] = Slot{ qToLittleEndian(it->offset),
+                                              qToLittleEndian(it->size) };
+        }
+    }
+
+    Header h;
+    std::memcpy(h.magic, PACK_MAGIC, 4);
+    h.version     = qToLittleEndian(PACK_VERSION);
+    h.count       = qToLittleEndian(quint32(KanaCatalog::Count));
+    h.kinds       = qToLittleEndian(quint32(KindCount));
+    h.fingerprint = qToLittleEndian(KanaCatalog::fingerprint());
+
+    QSaveFile out(outPath);
+    if (!out.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Cannot write asset pack:" << outPath << out.errorString();
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char *>(table.constData()), table.size() * sizeof(Slot));
+    out.write(blobs);
+    return out.commit();
+}
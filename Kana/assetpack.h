@@ -0,0 +1,67 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+
+// One file holding every stroke image and sound clip, indexed by catalog id.
+//
+// Layout (little endian):
+//   Header   magic "KPAK", version, catalog count, kinds, catalog fingerprint
+//   Table    Count * KindCount { quint32 offset; quint32 size; }
+//   Blobs    raw .jpg / .mp3 bytes (identical files are stored once)
+//
+// At runtime the file is memory-mapped and data() returns views into the
+// mapping, so a lookup is one table read with no open/stat/copy.
+class AssetPack
+{
+public:
+    enum class Kind { HiraganaStroke, KatakanaStroke, Sound };
+    static constexpr int KindCount = 3;
+
+    // Pack next to the executable, so the working directory doesn't matter
+    static AssetPack *instance();
+    static QString defaultPath();
+
+    bool open(const QString &path);
+    bool isOpen() const { return m_base != nullptr; }
+
+    // Zero-copy view; valid while the pack is open. Empty if absent.
+    QByteArray data(Kind kind, int id) const;
+    bool contains(Kind kind, int id) const;
+
+    static Kind strokeKind(bool isHiragana)
+    {
+        return isHiragana ? Kind::HiraganaStroke : Kind::KatakanaStroke;
+    }
+
+    // Build step: packs data/strokes and data/sounds from `dataDir`
+    static bool build(const QString &dataDir, const QString &outPath);
+
+private:
+    struct Header
+    {
+        char    magic[4];
+        quint32 version;
+        quint32 count;
+        quint32 kinds;
+        quint32 fingerprint;
+    };
+
+    struct Slot
+    {
+        quint32 offset;
+        quint32 size;
+    };
+
+    static QString sourcePath(const QString &dataDir, Kind kind, int id);
+
+    QFile        m_file;
+    const uchar *m_base = nullptr;
+    qint64       m_size = 0;
+    const Slot  *m_table = nullptr;
+};
+
+#endif // ASSETPACK_H
@@ -0,0 +1,342 @@
+#include "audioservice.h"
+#include "kanacatalog.h"
+#include "assetpack.h"
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+#include <QUrl>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QIODevice>
+#include <QBuffer>
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QAudioSink>
+#include <QAudioDevice>
+#include <QMediaDevices>
+#include <QDebug>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+
+// Device buffer; smaller means less delay between click and sound
+static const int SINK_BUFFER_US = 30000;
+
+// The sink is suspended after this much silence
+static const int IDLE_SUSPEND_MS = 3000;
+
+
+// Endless PCM stream for the sink: the current clip, then silence.
+// Starting a clip only swaps the buffer, the device stays open.
+class PcmMixer : public QIODevice
+{
+public:
+    void setClip(const QByteArray &pcm)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_clip = pcm;
+        m_pos = 0;
+    }
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override
+    {
+        return std::numeric_limits<int>::max();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override
+    {
+        QMutexLocker lock(&m_mutex);
+
+        const qint64 n = qBound<qint64>(0, m_clip.size() - m_pos, maxlen);
+        if (n > 0)
+        {
+            std::memcpy(data, m_clip.constData() + m_pos, size_t(n));
+            m_pos += n;
+        }
+
+        // Int16 / Float silence is all zero bits
+        std::memset(data + n, 0, size_t(maxlen - n));
+        return maxlen;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    QMutex     m_mutex;
+    QByteArray m_clip;
+    qint64     m_pos = 0;
+};
+
+
+// Decoder (audio thread)
+void AudioDecodeWorker::decode(int id, const QString &path, const QByteArray &encoded,
+                               const QAudioFormat &format)
+{
+    KANA_TRACE_SCOPE("AudioDecodeWorker::decode");
+
+    auto *decoder = new QAudioDecoder(this);
+    decoder->setAudioFormat(format);
+
+    if (!encoded.isEmpty())
+    {
+        auto *in = new QBuffer(decoder);
+        in->setData(encoded);
+        in->open(QIODevice::ReadOnly);
+        decoder->setSourceDevice(in);
+    }
+    else
+    {
+        decoder->setSource(QUrl::fromLocalFile(path));
+    }
+
+    auto pcm  = std::make_shared<QByteArray>();
+    auto fmt  = std::make_shared<QAudioFormat>(format);
+    auto done = std::make_shared<bool>(false);
+
+    connect(decoder, &QAudioDecoder::bufferReady, this, [decoder, pcm, fmt]() {
+        const QAudioBuffer buf = decoder->read();
+        if (!buf.isValid())
+            return;
+
+        *fmt = buf.format();
+        pcm->append(buf.constData<char>(), buf.byteCount());
+    });
+
+    connect(decoder, &QAudioDecoder::finished, this, [this, decoder, id, pcm, fmt, done]() {
+        if (*done)
+            return;
+        *done = true;
+
+        emit decoded(id, *fmt, *pcm);
+        decoder->deleteLater();
+    });
+
+    connect(decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            [this, decoder, id, path, done](QAudioDecoder::Error) {
+        if (*done)
+            return;
+        *done = true;
+
+        qDebug() << "Audio decode failed:" << path << decoder->errorString();
+        emit failed(id);
+        decoder->deleteLater();
+    });
+
+    decoder->start();
+}
+
+
+// Service
+AudioService *AudioService::instance()
+{
+    static AudioService *service = new AudioService(QCoreApplication::instance());
+    return service;
+}
+
+AudioService::AudioService(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<QAudioFormat>();
+
+    // Decode straight into what the output device takes, so playback
+    // never converts
+    const QAudioDevice dev = QMediaDevices::defaultAudioOutput();
+    m_format = dev.preferredFormat();
+    m_format.setSampleFormat(QAudioFormat::Int16);
+    if (!dev.isFormatSupported(m_format))
+        m_format = dev.preferredFormat();
+
+    m_thread = new QThread(this);
+    m_worker = new AudioDecodeWorker();
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &AudioDecodeWorker::decoded, this, &AudioService::onDecoded);
+    connect(m_worker, &AudioDecodeWorker::failed, this, &AudioService::onFailed);
+    m_thread->start();
+
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    connect(m_idleTimer, &QTimer::timeout, this, [this]() {
+        if (m_sink)
+            m_sink->suspend();
+    });
+
+    queueAll();
+}
+
+AudioService::~AudioService()
+{
+    if (m_sink)
+        m_sink->stop();
+
+    m_thread->quit();
+    m_thread->wait();
+}
+
+QString AudioService::pathFor(int id)
+{
+    return QString("data/sounds/%1.mp3").arg(KanaCatalog::displayRomaji(id));
+}
+
+bool AudioService::hasClip(int id)
+{
+    return KanaCatalog::isValid(id) && !m_clips[id].missing;
+}
+
+bool AudioService::isReady(int id) const
+{
+    return KanaCatalog::isValid(id) && !m_clips[id].pcm.isEmpty();
+}
+
+
+// Decode queue: every clip once, requested ones first
+void AudioService::queueAll()
+{
+    m_clips.resize(KanaCatalog::Count);
+
+    const AssetPack *pack = AssetPack::instance();
+
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+    {
+        const bool present = pack->isOpen() ? pack->contains(AssetPack::Kind::Sound, id)
+                                            : QFile::exists(pathFor(id));
+        if (!present)
+        {
+            m_clips[id].missing = true;
+            continue;
+        }
+        m_queue.append(id);
+    }
+
+    decodeNext();
+}
+
+void AudioService::preload(int id)
+{
+    if (!hasClip(id) || isReady(id) || id == m_decoding)
+        return;
+
+    m_queue.removeOne(id);
+    m_queue.prepend(id);
+    decodeNext();
+}
+
+void AudioService::decodeNext()
+{
+    if (m_decoding >= 0 || m_queue.isEmpty())
+        return;
+
+    m_decoding = m_queue.takeFirst();
+
+    AudioDecodeWorker *w = m_worker;
+    const int id = m_decoding;
+    const QString path = pathFor(id);
+    const QByteArray encoded = AssetPack::instance()->data(AssetPack::Kind::Sound, id);
+    const QAudioFormat format = m_format;
+    QMetaObject::invokeMethod(m_worker, [w, id, path, encoded, format]() {
+        w->decode(id, path, encoded, format);
+    });
+}
+
+void AudioService::onDecoded(int id, const QAudioFormat &format, const QByteArray &pcm)
+{
+    m_decoding = -1;
+
+    if (pcm.isEmpty())
+    {
+        onFailed(id);
+        return;
+    }
+
+    // ji(di) / ji and friends share one file: decode once, share the buffer
+    const QString path = pathFor(id);
+    for (int other = 0; other < KanaCatalog::Count; ++other)
+    {
+        if (other != id && (isReady(other) || pathFor(other) != path))
+            continue;
+
+        m_clips[other].format = format;
+        m_clips[other].pcm = pcm;
+        m_queue.removeOne(other);
+        emit clipReady(other);
+
+        if (other == m_playPending)
+            play(other);
+    }
+
+    decodeNext();
+}
+
+void AudioService::onFailed(int id)
+{
+    m_decoding = -1;
+    m_clips[id].missing = true;
+
+    if (id == m_playPending)
+        m_playPending = -1;
+
+    decodeNext();
+}
+
+
+// Playback
+void AudioService::ensureSink(const QAudioFormat &format)
+{
+    if (m_sink && m_sink->format() == format)
+        return;
+
+    if (m_sink)
+    {
+        m_sink->stop();
+        delete m_sink;
+    }
+
+    if (!m_mixer)
+    {
+        m_mixer = new PcmMixer();
+        m_mixer->open(QIODevice::ReadOnly);
+        m_mixer->setParent(this);
+    }
+
+    m_sink = new QAudioSink(QMediaDevices::defaultAudioOutput(), format, this);
+    m_sink->setBufferSize(format.bytesForDuration(SINK_BUFFER_US));
+    m_sink->start(m_mixer);
+}
+
+void AudioService::play(int id)
+{
+    if (!hasClip(id))
+        return;
+
+    if (!isReady(id))
+    {
+        m_playPending = id;
+        preload(id);
+        return;
+    }
+
+    m_playPending = -1;
+
+    const Clip &clip = m_clips[id];
+    ensureSink(clip.format);
+
+    m_mixer->setClip(clip.pcm);
+    if (m_sink->state() == QAudio::SuspendedState)
+        m_sink->resume();
+
+    m_idleTimer->start(int(clip.format.durationForBytes(clip.pcm.size()) / 1000) + IDLE_SUSPEND_MS);
+}
+
+void AudioService::stop()
+{
+    m_playPending = -1;
+    if (m_mixer)
+        m_mixer->setClip(QByteArray());
+}
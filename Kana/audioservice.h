@@ -0,0 +1,90 @@
+#ifndef AUDIOSERVICE_H
+#define AUDIOSERVICE_H
+
+#include <QObject>
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QVector>
+
+class QThread;
+class QTimer;
+class QAudioSink;
+class PcmMixer;
+
+// Decodes one clip to PCM in the requested format. Lives on the audio thread,
+// one QAudioDecoder at a time.
+class AudioDecodeWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    using QObject::QObject;
+
+public slots:
+    // `encoded` is the packed MP3 if there is a pack, else `path` is read
+    void decode(int id, const QString &path, const QByteArray &encoded,
+                const QAudioFormat &format);
+
+signals:
+    void decoded(int id, const QAudioFormat &format, const QByteArray &pcm);
+    void failed(int id);
+};
+
+
+// Pronunciation clips (asset pack, or data/sounds/), shared by every page.
+// All clips are decoded once, lazily and off the GUI thread, into PCM in the
+// output device's format; playback just points an always-open QAudioSink at
+// the buffer, so a click is heard within one device period.
+class AudioService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AudioService *instance();
+    ~AudioService();
+
+    static QString pathFor(int id);   // id = KanaCatalog id
+    bool hasClip(int id);
+
+    // Moves `id` to the front of the decode queue
+    void preload(int id);
+    bool isReady(int id) const;
+
+    // Plays at once if decoded, otherwise as soon as the clip is ready
+    void play(int id);
+    void stop();
+
+signals:
+    void clipReady(int id);
+
+private:
+    explicit AudioService(QObject *parent = nullptr);
+
+    void queueAll();
+    void decodeNext();
+    void onDecoded(int id, const QAudioFormat &format, const QByteArray &pcm);
+    void onFailed(int id);
+    void ensureSink(const QAudioFormat &format);
+
+    struct Clip
+    {
+        QAudioFormat format;
+        QByteArray   pcm;
+        bool         missing = false;
+    };
+
+    QVector<Clip> m_clips;            // by KanaCatalog id
+    QVector<int>  m_queue;            // ids waiting for the decoder
+    int           m_decoding    = -1;
+    int           m_playPending = -1;
+    QAudioFormat  m_format;           // what the decoder is asked for
+
+    QThread           *m_thread = nullptr;
+    AudioDecodeWorker *m_worker = nullptr;
+
+    QAudioSink *m_sink  = nullptr;
+    PcmMixer   *m_mixer = nullptr;
+    QTimer     *m_idleTimer = nullptr;
+};
+
+#endif // AUDIOSERVICE_H
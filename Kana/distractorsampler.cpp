@@ -0,0 +1,209 @@
+#include "distractorsampler.h"
+#include "kanacatalog.h"
+
+#include <QVarLengthArray>
+#include <iterator>
+#include <utility>
+
+// Visually similar symbols, used before there is any confusion history
+struct LookAlike
+{
+    char16_t a;
+    char16_t b;
+};
+
+static constexpr LookAlike HIRAGANA_LOOKALIKES[] = {
+    { u'ぬ', u'め' }, { u'ね', u'れ' }, { u'ね', u'わ' }, { u'れ', u'わ' },
+    { u'る', u'ろ' }, { u'は', u'ほ' }, { u'ほ', u'ま' }, { u'さ', u'ち' },
+    { u'き', u'さ' }, { u'い', u'り' }, { u'こ', u'に' }, { u'あ', u'お' },
+    { u'め', u'あ' }, { u'け', u'は' }, { u'う', u'ら' }, { u'す', u'む' },
+};
+
+static constexpr LookAlike KATAKANA_LOOKALIKES[] = {
+    { u'シ', u'ツ' }, { u'ソ', u'ン' }, { u'シ', u'ン' }, { u'ソ', u'ツ' },
+    { u'ク', u'ケ' }, { u'ク', u'タ' }, { u'ワ', u'ウ' }, { u'フ', u'ワ' },
+    { u'ヌ', u'ス' }, { u'ル', u'レ' }, { u'コ', u'ユ' }, { u'チ', u'テ' },
+    { u'ナ', u'メ' }, { u'ノ', u'メ' }, { u'マ', u'ム' }, { u'セ', u'ヤ' },
+    { u'ロ', u'コ' }, { u'ヲ', u'ヨ' }, { u'ラ', u'ウ' },
+};
+
+static const int LOOKALIKE_WEIGHT = 2;
+
+// Lowest id with the same displayRomaji, which is also what picks the clip
+int DistractorSampler::soundOf(int id)
+{
+    static const QVector<int> sounds = []() {
+        QVector<int> s(KanaCatalog::Count);
+        for (int id = 0; id < KanaCatalog::Count; ++id)
+        {
+            s[id] = id;
+            for (int other = 0; other < id; ++other)
+            {
+                if (KanaCatalog::displayRomaji(other) == KanaCatalog::displayRomaji(id))
+                {
+                    s[id] = s[other];
+                    break;
+                }
+            }
+        }
+        return s;
+    }();
+
+    return KanaCatalog::isValid(id) ? sounds[id] : -1;
+}
+
+DistractorSampler::DistractorSampler()
+    : m_rng(QRandomGenerator::global()->generate())
+{
+    m_catalog.reserve(KanaCatalog::Count);
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+        m_catalog.append(id);
+
+    clearConfusions();
+}
+
+void DistractorSampler::setPool(const QVector<int> &hiraganaIds, const QVector<int> &katakanaIds)
+{
+    m_pool[0] = hiraganaIds;
+    m_pool[1] = katakanaIds;
+
+    // Romaji options: one entry per sound, whichever script it came from
+    bool seen[KanaCatalog::Count] = {};
+    m_pool[2].clear();
+    for (const QVector<int> *ids : { &hiraganaIds, &katakanaIds })
+    {
+        for (int id : *ids)
+        {
+            if (KanaCatalog::isValid(id) && !seen[id])
+            {
+                seen[id] = true;
+                m_pool[2].append(id);
+            }
+        }
+    }
+}
+
+
+// Confusion data
+void DistractorSampler::clearConfusions()
+{
+    for (int s = 0; s < 2; ++s)
+        m_confusable[s].fill(QVector<Weighted>(), KanaCatalog::Count);
+
+    auto addPairs = [this](const LookAlike *pairs, int n, bool hira) {
+        for (int i = 0; i < n; ++i)
+        {
+            const int a = KanaCatalog::idOf(pairs[i].a, 0);
+            const int b = KanaCatalog::idOf(pairs[i].b, 0);
+            if (a < 0 || b < 0)
+                continue;
+            addConfusion(hira, a, b, LOOKALIKE_WEIGHT);
+            addConfusion(hira, b, a, LOOKALIKE_WEIGHT);
+        }
+    };
+
+    addPairs(HIRAGANA_LOOKALIKES, int(std::size(HIRAGANA_LOOKALIKES)), true);
+    addPairs(KATAKANA_LOOKALIKES, int(std::size(KATAKANA_LOOKALIKES)), false);
+}
+
+void DistractorSampler::addConfusion(bool isHiragana, int shownId, int chosenId, int weight)
+{
+    if (!KanaCatalog::isValid(shownId) || !KanaCatalog::isValid(chosenId) ||
+        shownId == chosenId || weight <= 0)
+        return;
+
+    QVector<Weighted> &list = m_confusable[isHiragana ? 0 : 1][shownId];
+    for (Weighted &w : list)
+    {
+        if (w.id == chosenId)
+        {
+            w.weight += weight;
+            return;
+        }
+    }
+    list.append({ chosenId, weight });
+}
+
+
+// Drawing
+bool DistractorSampler::contains(const int *ids, int n, int id)
+{
+    for (int i = 0; i < n; ++i)
+        if (ids[i] == id)
+            return true;
+    return false;
+}
+
+int DistractorSampler::draw(int correctId, bool isHiragana, bool sameScriptOnly, int k, int *out,
+                            bool distinctSound)
+{
+    const int slot = sameScriptOnly ? (isHiragana ? 0 : 1) : 2;
+    const int correctSound = distinctSound ? soundOf(correctId) : -1;
+    int taken = 0;
+
+    // Keep at least one plain random option so look-alikes don't give it away
+    if (m_mode == Mode::Confusable)
+        taken = drawConfusable(correctId, isHiragana, k > 1 ? k - 1 : k, out, correctSound);
+
+    taken = drawUniform(m_pool[slot], k, out, taken, correctId, correctSound);
+
+    // Tiny pools (e.g. three mastered symbols): top up from the catalog
+    if (taken < k)
+        taken = drawUniform(m_catalog, k, out, taken, correctId, correctSound);
+
+    return taken;
+}
+
+// Partial Fisher-Yates: at most candidates.size() steps, usually k + 1.
+// The array stays a permutation, so it is reused without reshuffling.
+int DistractorSampler::drawUniform(QVector<int> &candidates, int k, int *out, int taken,
+                                   int correctId, int correctSound)
+{
+    const int n = candidates.size();
+    for (int i = 0; i < n && taken < k; ++i)
+    {
+        const int j = i + int(m_rng.bounded(quint32(n - i)));
+        std::swap(candidates[i], candidates[j]);
+
+        const int id = candidates[i];
+        if (id == correctId || contains(out, taken, id))
+            continue;
+        if (correctSound >= 0 && soundOf(id) == correctSound)
+            continue;
+
+        out[taken++] = id;
+    }
+    return taken;
+}
+
+// Weighted sampling without replacement over the (short) neighbour list
+int DistractorSampler::drawConfusable(int correctId, bool isHiragana, int k, int *out,
+                                      int correctSound)
+{
+    if (!KanaCatalog::isValid(correctId))
+        return 0;
+
+    const QVector<Weighted> &list = m_confusable[isHiragana ? 0 : 1][correctId];
+    QVarLengthArray<Weighted, 16> left;
+    for (const Weighted &w : list)
+        if (correctSound < 0 || soundOf(w.id) != correctSound)
+            left.append(w);
+
+    int taken = 0;
+    while (taken < k && !left.isEmpty())
+    {
+        int total = 0;
+        for (const Weighted &w : left)
+            total += w.weight;
+
+        int r = int(m_rng.bounded(quint32(total)));
+        int pick = 0;
+        while (r >= left[pick].weight)
+            r -= left[pick++].weight;
+
+        out[taken++] = left[pick].id;
+        left[pick] = left.back();
+        left.removeLast();
+    }
+    return taken;
+}
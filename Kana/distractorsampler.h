@@ -0,0 +1,62 @@
+#ifndef DISTRACTORSAMPLER_H
+#define DISTRACTORSAMPLER_H
+
+#include <QVector>
+#include <QRandomGenerator>
+
+// Picks wrong answer options for a question in bounded time.
+// Candidates are KanaCatalog ids kept in per-script arrays; k unique ones
+// are drawn with a partial Fisher-Yates shuffle (no rejection loops).
+// In Confusable mode look-alike symbols (シ/ツ, ソ/ン, ...) and symbols the
+// learner actually mixed up are preferred, weighted by how often.
+class DistractorSampler
+{
+public:
+    enum class Mode { Uniform, Confusable };
+
+    DistractorSampler();
+
+    void setMode(Mode mode) { m_mode = mode; }
+    void seed(quint32 s) { m_rng.seed(s); }
+
+    // Session symbols per script; the full catalog is the fallback
+    void setPool(const QVector<int> &hiraganaIds, const QVector<int> &katakanaIds);
+
+    // Extra confusion weight between two symbols of one script
+    void addConfusion(bool isHiragana, int shownId, int chosenId, int weight);
+    void clearConfusions();
+
+    // Fills `out` with up to k distinct ids != correctId, returns the count.
+    // sameScriptOnly: options are kana, so they must be in the question's script.
+    // distinctSound: the question is a sound clip, so homophones of the
+    // answer (ji / ji(di), zu / zu(du), ...) cannot be options.
+    int draw(int correctId, bool isHiragana, bool sameScriptOnly, int k, int *out,
+             bool distinctSound = false);
+
+    // Symbols sharing a sound key share a pronunciation and a clip
+    static int soundOf(int id);
+
+private:
+    struct Weighted
+    {
+        int id;
+        int weight;
+    };
+
+    int drawUniform(QVector<int> &candidates, int k, int *out, int taken,
+                    int correctId, int correctSound);
+    int drawConfusable(int correctId, bool isHiragana, int k, int *out, int correctSound);
+    static bool contains(const int *ids, int n, int id);
+
+    Mode m_mode = Mode::Uniform;
+    QRandomGenerator m_rng;
+
+    // 0 = Hiragana, 1 = Katakana, 2 = both (romaji options)
+    QVector<int> m_pool[3];
+    QVector<int> m_catalog;
+
+    // Sparse per-script neighbour lists, indexed by catalog id
+    QVector<QVector<Weighted>> m_confusable[2];
+};
+
+#endif // DISTRACTORSAMPLER_H
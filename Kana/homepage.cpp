@@ -49,8 +49,12 @@ void HomePage::buildUi()
         );
 
     btnKana = new QPushButton("Kana Table");
+    btnKana->setObjectName("kanaTableButton");
+
     btnPractice = new QPushButton("Practice");
+    btnPractice->setObjectName("practiceButton");
     btnStats = new QPushButton("Statistics");
+    btnStats->setObjectName("statisticsButton");
 
     for (auto b : {btnKana, btnPractice, btnStats}) {
         b->setMinimumHeight(70);
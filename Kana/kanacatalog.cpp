@@ -0,0 +1,98 @@
+#include "kanacatalog.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace
+{
+    struct Strings
+    {
+        QVector<QString> hiragana;
+        QVector<QString> katakana;
+        QVector<QString> romaji;
+        QVector<QString> display;
+        QHash<QString, int> romajiIds;
+
+        Strings()
+        {
+            hiragana.reserve(KanaCatalog::Count);
+            katakana.reserve(KanaCatalog::Count);
+            romaji.reserve(KanaCatalog::Count);
+            display.reserve(KanaCatalog::Count);
+
+            for (int i = 0; i < KanaCatalog::Count; ++i)
+            {
+                const auto &e = KanaCatalog::Entries[i];
+
+                QString h = QString::fromUtf16(e.hiragana);
+                QString k = h;
+                for (QChar &c : k)
+                    c = QChar(char16_t(c.unicode() + KanaCatalog::KatakanaShift));
+
+                const QString r = QString::fromLatin1(e.romaji);
+                const int paren = r.indexOf('(');
+
+                hiragana.append(h);
+                katakana.append(k);
+                romaji.append(r);
+                display.append(paren < 0 ? r : r.left(paren));
+                romajiIds.insert(r, i);
+            }
+        }
+    };
+
+    const Strings &strings()
+    {
+        static const Strings s;
+        return s;
+    }
+}
+
+QString KanaCatalog::kana(int id, bool isHiragana)
+{
+    if (!isValid(id))
+        return QString();
+    return isHiragana ? strings().hiragana[id] : strings().katakana[id];
+}
+
+QString KanaCatalog::romaji(int id)
+{
+    return isValid(id) ? strings().romaji[id] : QString();
+}
+
+QString KanaCatalog::displayRomaji(int id)
+{
+    return isValid(id) ? strings().display[id] : QString();
+}
+
+int KanaCatalog::idOfKana(const QString &kana, bool *isHiragana)
+{
+    if (kana.isEmpty() || kana.size() > 2)
+        return -1;
+
+    const char16_t c0 = kana[0].unicode();
+    const char16_t c1 = kana.size() > 1 ? kana[1].unicode() : char16_t(0);
+
+    if (isHiragana)
+        *isHiragana = c0 <= HiraganaLast;
+
+    return idOf(c0, c1);
+}
+
+int KanaCatalog::idOfRomaji(const QString &romaji)
+{
+    return strings().romajiIds.value(romaji, -1);
+}
+
+// FNV-1a over the romaji list
+quint32 KanaCatalog::fingerprint()
+{
+    quint32 h = 2166136261u;
+    for (int id = 0; id < Count; ++id)
+    {
+        for (const char *c = Entries[id].romaji; *c; ++c)
+            h = (h ^ quint8(*c)) * 16777619u;
+        h *= 16777619u;   // separator, so "a","ba" != "ab","a"
+    }
+    return h;
+}
@@ -0,0 +1,148 @@
+#ifndef KANACATALOG_H
+#define KANACATALOG_H
+
+#include <QString>
+#include <QStringList>
+
+// The one kana inventory shared by every page.
+// Each sound has a dense id (0..Count-1) in table order; the same id names
+// the Hiragana and the Katakana symbol (か / カ), the script is a separate bool.
+// Everything below is constexpr, the QString helpers only cache conversions.
+namespace KanaCatalog
+{
+    enum class Group { Gojuon, Dakuon, Handakuon, Yoon };
+
+    struct Entry
+    {
+        const char16_t *hiragana;
+        const char     *romaji;   // stats / asset key, e.g. "ji(di)"
+        Group           group;
+        int             row;      // position in the kana table
+        int             column;
+    };
+
+    constexpr Entry Entries[] = {
+        // Gojuon
+        { u"あ", "a", Group::Gojuon, 0, 0 }, { u"い", "i", Group::Gojuon, 0, 1 }, { u"う", "u", Group::Gojuon, 0, 2 }, { u"え", "e", Group::Gojuon, 0, 3 }, { u"お", "o", Group::Gojuon, 0, 4 },
+        { u"か", "ka", Group::Gojuon, 1, 0 }, { u"き", "ki", Group::Gojuon, 1, 1 }, { u"く", "ku", Group::Gojuon, 1, 2 }, { u"け", "ke", Group::Gojuon, 1, 3 }, { u"こ", "ko", Group::Gojuon, 1, 4 },
+        { u"さ", "sa", Group::Gojuon, 2, 0 }, { u"し", "shi", Group::Gojuon, 2, 1 }, { u"す", "su", Group::Gojuon, 2, 2 }, { u"せ", "se", Group::Gojuon, 2, 3 }, { u"そ", "so", Group::Gojuon, 2, 4 },
+        { u"た", "ta", Group::Gojuon, 3, 0 }, { u"ち", "chi", Group::Gojuon, 3, 1 }, { u"つ", "tsu", Group::Gojuon, 3, 2 }, { u"て", "te", Group::Gojuon, 3, 3 }, { u"と", "to", Group::Gojuon, 3, 4 },
+        { u"な", "na", Group::Gojuon, 4, 0 }, { u"に", "ni", Group::Gojuon, 4, 1 }, { u"ぬ", "nu", Group::Gojuon, 4, 2 }, { u"ね", "ne", Group::Gojuon, 4, 3 }, { u"の", "no", Group::Gojuon, 4, 4 },
+        { u"は", "ha", Group::Gojuon, 5, 0 }, { u"ひ", "hi", Group::Gojuon, 5, 1 }, { u"ふ", "fu", Group::Gojuon, 5, 2 }, { u"へ", "he", Group::Gojuon, 5, 3 }, { u"ほ", "ho", Group::Gojuon, 5, 4 },
+        { u"ま", "ma", Group::Gojuon, 6, 0 }, { u"み", "mi", Group::Gojuon, 6, 1 }, { u"む", "mu", Group::Gojuon, 6, 2 }, { u"め", "me", Group::Gojuon, 6, 3 }, { u"も", "mo", Group::Gojuon, 6, 4 },
+        { u"や", "ya", Group::Gojuon, 7, 0 }, { u"ゆ", "yu", Group::Gojuon, 7, 2 }, { u"よ", "yo", Group::Gojuon, 7, 4 },
+        { u"ら", "ra", Group::Gojuon, 8, 0 }, { u"り", "ri", Group::Gojuon, 8, 1 }, { u"る", "ru", Group::Gojuon, 8, 2 }, { u"れ", "re", Group::Gojuon, 8, 3 }, { u"ろ", "ro", Group::Gojuon, 8, 4 },
+        { u"わ", "wa", Group::Gojuon, 9, 0 }, { u"を", "wo", Group::Gojuon, 9, 4 },
+        { u"ん", "n", Group::Gojuon, 10, 2 },
+
+        // Dakuon
+        { u"が", "ga", Group::Dakuon, 0, 0 }, { u"ぎ", "gi", Group::Dakuon, 0, 1 }, { u"ぐ", "gu", Group::Dakuon, 0, 2 }, { u"げ", "ge", Group::Dakuon, 0, 3 }, { u"ご", "go", Group::Dakuon, 0, 4 },
+        { u"ざ", "za", Group::Dakuon, 1, 0 }, { u"じ", "ji", Group::Dakuon, 1, 1 }, { u"ず", "zu", Group::Dakuon, 1, 2 }, { u"ぜ", "ze", Group::Dakuon, 1, 3 }, { u"ぞ", "zo", Group::Dakuon, 1, 4 },
+        { u"だ", "da", Group::Dakuon, 2, 0 }, { u"ぢ", "ji(di)", Group::Dakuon, 2, 1 }, { u"づ", "zu(du)", Group::Dakuon, 2, 2 }, { u"で", "de", Group::Dakuon, 2, 3 }, { u"ど", "do", Group::Dakuon, 2, 4 },
+
+        // Handakuon
+        { u"ば", "ba", Group::Handakuon, 0, 0 }, { u"び", "bi", Group::Handakuon, 0, 1 }, { u"ぶ", "bu", Group::Handakuon, 0, 2 }, { u"べ", "be", Group::Handakuon, 0, 3 }, { u"ぼ", "bo", Group::Handakuon, 0, 4 },
+        { u"ぱ", "pa", Group::Handakuon, 1, 0 }, { u"ぴ", "pi", Group::Handakuon, 1, 1 }, { u"ぷ", "pu", Group::Handakuon, 1, 2 }, { u"ぺ", "pe", Group::Handakuon, 1, 3 }, { u"ぽ", "po", Group::Handakuon, 1, 4 },
+
+        // Yoon
+        { u"きゃ", "kya", Group::Yoon, 0, 0 }, { u"きゅ", "kyu", Group::Yoon, 0, 1 }, { u"きょ", "kyo", Group::Yoon, 0, 2 },
+        { u"ぎゃ", "gya", Group::Yoon, 1, 0 }, { u"ぎゅ", "gyu", Group::Yoon, 1, 1 }, { u"ぎょ", "gyo", Group::Yoon, 1, 2 },
+        { u"しゃ", "sha", Group::Yoon, 2, 0 }, { u"しゅ", "shu", Group::Yoon, 2, 1 }, { u"しょ", "sho", Group::Yoon, 2, 2 },
+        { u"じゃ", "ja", Group::Yoon, 3, 0 }, { u"じゅ", "ju", Group::Yoon, 3, 1 }, { u"じょ", "jo", Group::Yoon, 3, 2 },
+        { u"ちゃ", "cha", Group::Yoon, 4, 0 }, { u"ちゅ", "chu", Group::Yoon, 4, 1 }, { u"ちょ", "cho", Group::Yoon, 4, 2 },
+        { u"ぢゃ", "ja(chi)", Group::Yoon, 5, 0 }, { u"ぢゅ", "ju(chi)", Group::Yoon, 5, 1 }, { u"ぢょ", "jo(chi)", Group::Yoon, 5, 2 },
+        { u"にゃ", "nya", Group::Yoon, 6, 0 }, { u"にゅ", "nyu", Group::Yoon, 6, 1 }, { u"にょ", "nyo", Group::Yoon, 6, 2 },
+        { u"ひゃ", "hya", Group::Yoon, 7, 0 }, { u"ひゅ", "hyu", Group::Yoon, 7, 1 }, { u"ひょ", "hyo", Group::Yoon, 7, 2 },
+        { u"みゃ", "mya", Group::Yoon, 8, 0 }, { u"みゅ", "myu", Group::Yoon, 8, 1 }, { u"みょ", "myo", Group::Yoon, 8, 2 },
+        { u"りゃ", "rya", Group::Yoon, 9, 0 }, { u"りゅ", "ryu", Group::Yoon, 9, 1 }, { u"りょ", "ryo", Group::Yoon, 9, 2 },
+    };
+
+    constexpr int Count = int(sizeof(Entries) / sizeof(Entries[0]));
+
+    constexpr int GroupCount = 4;
+
+    constexpr const char *groupTitle(Group g)
+    {
+        return g == Group::Gojuon    ? "Gojuon (basic)"
+             : g == Group::Dakuon    ? "Dakuon"
+             : g == Group::Handakuon ? "Handakuon"
+                                     : "Yoon";
+    }
+
+    constexpr int groupColumns(Group g)
+    {
+        return g == Group::Yoon ? 3 : 5;
+    }
+
+    // Kana -> id, without any map.
+    // Katakana is folded onto Hiragana (U+30A1.. -> U+3041..), then the
+    // base code point and an optional small ya/yu/yo index a flat table.
+    constexpr char16_t HiraganaFirst = 0x3041;
+    constexpr char16_t HiraganaLast  = 0x3096;
+    constexpr char16_t KatakanaShift = 0x60;
+
+    constexpr char16_t toHiraganaUnit(char16_t c)
+    {
+        return (c >= HiraganaFirst + KatakanaShift && c <= HiraganaLast + KatakanaShift)
+                   ? char16_t(c - KatakanaShift) : c;
+    }
+
+    constexpr int smallSlot(char16_t c)
+    {
+        return c == u'ゃ' ? 1 : c == u'ゅ' ? 2 : c == u'ょ' ? 3 : 0;
+    }
+
+    struct KanaIndex
+    {
+        short id[(HiraganaLast - HiraganaFirst + 1) * 4];
+    };
+
+    constexpr KanaIndex buildKanaIndex()
+    {
+        KanaIndex idx {};
+        for (short &v : idx.id)
+            v = -1;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            const char16_t *k = Entries[i].hiragana;
+            const int slot = k[1] ? smallSlot(k[1]) : 0;
+            idx.id[(k[0] - HiraganaFirst) * 4 + slot] = short(i);
+        }
+        return idx;
+    }
+
+    constexpr KanaIndex Index = buildKanaIndex();
+
+    // c1 is 0 for single-character kana
+    constexpr int idOf(char16_t c0, char16_t c1)
+    {
+        c0 = toHiraganaUnit(c0);
+        if (c0 < HiraganaFirst || c0 > HiraganaLast)
+            return -1;
+
+        int slot = 0;
+        if (c1)
+        {
+            slot = smallSlot(toHiraganaUnit(c1));
+            if (!slot)
+                return -1;
+        }
+        return Index.id[(c0 - HiraganaFirst) * 4 + slot];
+    }
+
+    constexpr bool isValid(int id) { return id >= 0 && id < Count; }
+
+    // Cached QString views of the table
+    QString kana(int id, bool isHiragana);
+    QString romaji(int id);
+    QString displayRomaji(int id);   // "ji(di)" -> "ji"
+
+    int idOfKana(const QString &kana, bool *isHiragana = nullptr);
+    int idOfRomaji(const QString &romaji);
+
+    // Hash of the romaji list; files built for another catalog compare unequal
+    quint32 fingerprint();
+}
+
+#endif // KANACATALOG_H
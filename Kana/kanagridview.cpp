@@ -0,0 +1,280 @@
+#include "kanagridview.h"
+#include "trace.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QScrollBar>
+#include <QtMath>
+#include <algorithm>
+
+// Layout (matches the old widget-based table)
+static const int MARGIN          = 11;
+static const int SECTION_SPACING = 26;
+static const int TITLE_GAP       = 12;
+static const int CELL_SPACING    = 14;
+static const int CELL_HEIGHT     = 90;
+static const int CELL_RADIUS     = 14;
+
+static const QColor CARD_COLOR   ("#2a2a2a");
+static const QColor HOVER_COLOR  ("#363636");
+static const QColor KANA_COLOR   (Qt::white);
+static const QColor ROMAJI_COLOR ("#bbbbbb");
+static const QColor TITLE_COLOR  (Qt::white);
+
+
+KanaGridView::KanaGridView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+{
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    verticalScrollBar()->setSingleStep(24);
+    viewport()->setMouseTracking(true);
+
+    m_kanaFont.setPointSize(28);
+    m_kanaFont.setBold(true);
+    m_romajiFont.setPointSize(11);
+    m_titleFont.setPointSize(16);
+    m_titleFont.setBold(true);
+
+    buildGlyphs();
+}
+
+void KanaGridView::setHiragana(bool isHiragana)
+{
+    if (m_isHiragana == isHiragana)
+        return;
+
+    m_isHiragana = isHiragana;
+    viewport()->update();
+}
+
+
+// Glyph cache: every string is shaped once, painting only blits it
+void KanaGridView::buildGlyphs()
+{
+    auto prepared = [](const QString &text, const QFont &font) {
+        QStaticText st(text);
+        st.setTextFormat(Qt::PlainText);
+        st.setPerformanceHint(QStaticText::AggressiveCaching);
+        st.prepare(QTransform(), font);
+        return st;
+    };
+
+    for (int s = 0; s < 2; ++s)
+    {
+        m_kana[s].clear();
+        m_kana[s].reserve(KanaCatalog::Count);
+        for (int id = 0; id < KanaCatalog::Count; ++id)
+            m_kana[s].append(prepared(KanaCatalog::kana(id, s == 0), m_kanaFont));
+    }
+
+    m_romaji.clear();
+    m_romaji.reserve(KanaCatalog::Count);
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+        m_romaji.append(prepared(KanaCatalog::displayRomaji(id), m_romajiFont));
+
+    for (int g = 0; g < KanaCatalog::GroupCount; ++g)
+        m_titles[g] = prepared(KanaCatalog::groupTitle(KanaCatalog::Group(g)), m_titleFont);
+}
+
+
+// Layout: recomputed only when the width changes
+void KanaGridView::relayout()
+{
+    KANA_TRACE_SCOPE("KanaGridView::relayout");
+
+    const int width = viewport()->width();
+    if (width != m_layoutWidth)
+    {
+        m_layoutWidth = width;
+        m_cells.clear();
+        m_headers.clear();
+        m_cellOf.fill(-1, KanaCatalog::Count);
+
+        const int inner = qMax(0, width - 2 * MARGIN);
+        int y = MARGIN;
+
+        for (int g = 0; g < KanaCatalog::GroupCount; ++g)
+        {
+            const auto group = KanaCatalog::Group(g);
+            const int titleHeight = qCeil(m_titles[g].size().height());
+
+            m_headers.append({ QRect(MARGIN, y, inner, titleHeight), group });
+            y += titleHeight + TITLE_GAP;
+
+            const int cols = KanaCatalog::groupColumns(group);
+            const int cellWidth = qMax(1, (inner - (cols - 1) * CELL_SPACING) / cols);
+            int rows = 0;
+
+            // Catalog order is table order, so cells stay sorted by top
+            for (int id = 0; id < KanaCatalog::Count; ++id)
+            {
+                const auto &e = KanaCatalog::Entries[id];
+                if (e.group != group)
+                    continue;
+
+                const QRect r(MARGIN + e.column * (cellWidth + CELL_SPACING),
+                              y + e.row * (CELL_HEIGHT + CELL_SPACING),
+                              cellWidth, CELL_HEIGHT);
+
+                m_cellOf[id] = m_cells.size();
+                m_cells.append({ r, id });
+                rows = qMax(rows, e.row + 1);
+            }
+
+            y += rows * CELL_HEIGHT + qMax(0, rows - 1) * CELL_SPACING + SECTION_SPACING;
+        }
+
+        m_contentHeight = y - SECTION_SPACING + MARGIN;
+    }
+
+    QScrollBar *sb = verticalScrollBar();
+    sb->setPageStep(viewport()->height());
+    sb->setRange(0, qMax(0, m_contentHeight - viewport()->height()));
+}
+
+void KanaGridView::resizeEvent(QResizeEvent *ev)
+{
+    QAbstractScrollArea::resizeEvent(ev);
+    relayout();
+}
+
+void KanaGridView::scrollContentsBy(int, int)
+{
+    viewport()->update();
+}
+
+
+// Painting: only cells intersecting the exposed rect
+void KanaGridView::paintEvent(QPaintEvent *ev)
+{
+    KANA_TRACE_SCOPE("KanaGridView::paintEvent");
+
+    if (m_layoutWidth != viewport()->width())
+        relayout();
+
+    const int scroll = verticalScrollBar()->value();
+    const QRect visible = ev->rect().translated(0, scroll);
+
+    QPainter p(viewport());
+    p.setRenderHint(QPainter::Antialiasing);
+    p.translate(0, -scroll);
+
+    p.setFont(m_titleFont);
+    p.setPen(TITLE_COLOR);
+    for (const Header &h : m_headers)
+        if (h.rect.intersects(visible))
+            p.drawStaticText(h.rect.topLeft(), m_titles[int(h.group)]);
+
+    auto first = std::lower_bound(m_cells.cbegin(), m_cells.cend(), visible.top(),
+                                  [](const Cell &c, int top) { return c.rect.bottom() < top; });
+    auto last = first;
+    while (last != m_cells.cend() && last->rect.top() <= visible.bottom())
+        ++last;
+
+    const QVector<QStaticText> &kana = m_kana[m_isHiragana ? 0 : 1];
+
+    // One pass per font so the painter never re-resolves fonts per cell
+    p.setPen(Qt::NoPen);
+    for (auto c = first; c != last; ++c)
+    {
+        p.setBrush(c->id == m_hovered ? HOVER_COLOR : CARD_COLOR);
+        p.drawRoundedRect(c->rect, CELL_RADIUS, CELL_RADIUS);
+    }
+
+    auto blockTop = [&](const Cell &c) {
+        const qreal h = kana[c.id].size().height() + m_romaji[c.id].size().height();
+        return c.rect.center().y() - h / 2;
+    };
+
+    p.setFont(m_kanaFont);
+    p.setPen(KANA_COLOR);
+    for (auto c = first; c != last; ++c)
+    {
+        const QStaticText &st = kana[c->id];
+        p.drawStaticText(QPointF(c->rect.x() + (c->rect.width() - st.size().width()) / 2,
+                                 blockTop(*c)), st);
+    }
+
+    p.setFont(m_romajiFont);
+    p.setPen(ROMAJI_COLOR);
+    for (auto c = first; c != last; ++c)
+    {
+        const QStaticText &st = m_romaji[c->id];
+        p.drawStaticText(QPointF(c->rect.x() + (c->rect.width() - st.size().width()) / 2,
+                                 blockTop(*c) + kana[c->id].size().height()), st);
+    }
+
+    p.end();
+    emit painted();
+}
+
+
+// Mouse
+int KanaGridView::idAt(const QPoint &pos) const
+{
+    const QPoint pt = pos + QPoint(0, verticalScrollBar()->value());
+
+    auto c = std::lower_bound(m_cells.cbegin(), m_cells.cend(), pt.y(),
+                              [](const Cell &cell, int y) { return cell.rect.bottom() < y; });
+    for (; c != m_cells.cend() && c->rect.top() <= pt.y(); ++c)
+        if (c->rect.contains(pt))
+            return c->id;
+    return -1;
+}
+
+QRect KanaGridView::cellRect(int id) const
+{
+    if (!KanaCatalog::isValid(id) || m_cellOf.isEmpty() || m_cellOf[id] < 0)
+        return QRect();
+    return m_cells[m_cellOf[id]].rect.translated(0, -verticalScrollBar()->value());
+}
+
+void KanaGridView::ensureVisible(int id)
+{
+    if (m_layoutWidth != viewport()->width())
+        relayout();
+
+    const QRect r = cellRect(id);
+    if (r.isNull())
+        return;
+
+    QScrollBar *sb = verticalScrollBar();
+    if (r.top() < 0)
+        sb->setValue(sb->value() + r.top() - MARGIN);
+    else if (r.bottom() > viewport()->height())
+        sb->setValue(sb->value() + r.bottom() - viewport()->height() + MARGIN);
+}
+
+void KanaGridView::setHovered(int id)
+{
+    if (id == m_hovered)
+        return;
+
+    viewport()->update(cellRect(m_hovered));
+    m_hovered = id;
+    viewport()->update(cellRect(m_hovered));
+    viewport()->setCursor(id >= 0 ? Qt::PointingHandCursor : Qt::ArrowCursor);
+}
+
+void KanaGridView::mouseMoveEvent(QMouseEvent *ev)
+{
+    setHovered(idAt(ev->position().toPoint()));
+}
+
+void KanaGridView::mouseReleaseEvent(QMouseEvent *ev)
+{
+    if (ev->button() != Qt::LeftButton)
+        return;
+
+    const int id = idAt(ev->position().toPoint());
+    if (id >= 0)
+        emit symbolClicked(id, m_isHiragana);
+}
+
+bool KanaGridView::viewportEvent(QEvent *ev)
+{
+    if (ev->type() == QEvent::Leave)
+        setHovered(-1);
+    return QAbstractScrollArea::viewportEvent(ev);
+}
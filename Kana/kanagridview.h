@@ -0,0 +1,80 @@
+#ifndef KANAGRIDVIEW_H
+#define KANAGRIDVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QVector>
+#include <QStaticText>
+#include <QFont>
+
+#include "kanacatalog.h"
+
+// The kana table as one painted widget.
+// Cards are laid out once per width from the catalog's row/column data and
+// drawn with cached QStaticText; paintEvent only touches the visible rows,
+// and switching script just swaps which glyph cache is used.
+class KanaGridView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit KanaGridView(QWidget *parent = nullptr);
+
+    void setHiragana(bool isHiragana);
+    bool isHiragana() const { return m_isHiragana; }
+
+    // Catalog id under a viewport position, -1 if none
+    int idAt(const QPoint &pos) const;
+
+    // Card of a symbol in viewport coordinates (empty if not laid out)
+    QRect cellRect(int id) const;
+    void ensureVisible(int id);
+
+signals:
+    void symbolClicked(int id, bool isHiragana);
+    void painted();
+
+protected:
+    void paintEvent(QPaintEvent *ev) override;
+    void resizeEvent(QResizeEvent *ev) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void mouseMoveEvent(QMouseEvent *ev) override;
+    void mouseReleaseEvent(QMouseEvent *ev) override;
+    bool viewportEvent(QEvent *ev) override;
+
+private:
+    struct Cell
+    {
+        QRect rect;     // content coordinates
+        int   id;
+    };
+
+    struct Header
+    {
+        QRect rect;
+        KanaCatalog::Group group;
+    };
+
+    void buildGlyphs();
+    void relayout();
+    void setHovered(int id);
+
+    bool m_isHiragana = true;
+    int  m_layoutWidth = -1;
+    int  m_contentHeight = 0;
+    int  m_hovered = -1;
+
+    // Both sorted by rect.top()
+    QVector<Cell>   m_cells;
+    QVector<Header> m_headers;
+    QVector<int>    m_cellOf;   // catalog id -> index in m_cells
+
+    QFont m_kanaFont;
+    QFont m_romajiFont;
+    QFont m_titleFont;
+
+    QVector<QStaticText> m_kana[2];   // 0 = Hiragana, 1 = Katakana
+    QVector<QStaticText> m_romaji;
+    QStaticText m_titles[KanaCatalog::GroupCount];
+};
+
+#endif // KANAGRIDVIEW_H
@@ -1,22 +1,22 @@
 #include "kanatablepage.h"
+#include "kanagridview.h"
 #include "DetailDialog.h"
+#include "trace.h"
 
-#include <QScrollArea>
 #include <QVBoxLayout>
-#include <QGridLayout>
-#include <QLabel>
 #include <QPushButton>
-#include <QDebug>
-#include <QMouseEvent>
-#include <QRegularExpression>
+#include <QLoggingCategory>
+
+// Toggles slower than one frame; reported with QT_LOGGING_RULES="kana.table.debug=true"
+static const qint64 SLOW_TOGGLE_US = 16000;
+
+Q_LOGGING_CATEGORY(lcTable, "kana.table", QtWarningMsg)
 
 
 KanaTablePage::KanaTablePage(QWidget *parent)
     : QWidget(parent)
 {
-    loadStaticKana();
     buildUi();
-    refreshTable();
 }
 
 
@@ -29,6 +29,8 @@ void KanaTablePage::buildUi()
     auto *topBar = new QHBoxLayout();
 
     btnHome = new QPushButton("← Home");
+    btnHome->setObjectName("homeButton");
+
     btnHome->setStyleSheet(
         "QPushButton { background:#333; color:white; padding:6px 14px;"
         "border-radius:8px; }"
@@ -36,7 +38,10 @@ void KanaTablePage::buildUi()
         );
 
     btnHiragana = new QPushButton("Hiragana");
+    btnHiragana->setObjectName("hiraganaButton");
+
     btnKatakana = new QPushButton("Katakana");
+    btnKatakana->setObjectName("katakanaButton");
 
     btnHiragana->setCheckable(true);
     btnKatakana->setCheckable(true);
@@ -62,301 +67,60 @@ void KanaTablePage::buildUi()
     connect(btnHiragana, &QPushButton::clicked, this, [this](){
         btnHiragana->setChecked(true);
         btnKatakana->setChecked(false);
-        refreshTable();
+        showScript(true);
     });
 
     connect(btnKatakana, &QPushButton::clicked, this, [this](){
         btnKatakana->setChecked(true);
         btnHiragana->setChecked(false);
-        refreshTable();
+        showScript(false);
     });
 
-    // Scroll
-    scrollArea = new QScrollArea();
-    scrollArea->setWidgetResizable(true);
-    scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-
-    scrollContent = new QWidget(scrollArea);
-    mainLayout = new QVBoxLayout(scrollContent);
-    mainLayout->setSpacing(26);
-
-    scrollArea->setWidget(scrollContent);
-    root->addWidget(scrollArea);
-}
-
+    // Table
+    grid = new KanaGridView();
+    grid->setHiragana(true);
+    root->addWidget(grid);
 
-// Static Kana Tables
-void KanaTablePage::loadStaticKana()
-{
-    // Hiragana
-    hira_gojuon = {
-        {"あ","い","う","え","お"},
-        {"か","き","く","け","こ"},
-        {"さ","し","す","せ","そ"},
-        {"た","ち","つ","て","と"},
-        {"な","に","ぬ","ね","の"},
-        {"は","ひ","ふ","へ","ほ"},
-        {"ま","み","む","め","も"},
-        {"や","","ゆ","","よ"},
-        {"ら","り","る","れ","ろ"},
-        {"わ","","","","を"},
-        {"","","ん","",""}
-    };
-
-    hira_dakuon = {
-        {"が","ぎ","ぐ","げ","ご"},
-        {"ざ","じ","ず","ぜ","ぞ"},
-        {"だ","ぢ","づ","で","ど"}
-    };
-
-    hira_handakuon = {
-        {"ば","び","ぶ","べ","ぼ"},
-        {"ぱ","ぴ","ぷ","ぺ","ぽ"}
-    };
-
-    hira_yoon = {
-        {"きゃ","きゅ","きょ"},
-        {"ぎゃ","ぎゅ","ぎょ"},
-        {"しゃ","しゅ","しょ"},
-        {"じゃ","じゅ","じょ"},
-        {"ちゃ","ちゅ","ちょ"},
-        {"ぢゃ","ぢゅ","ぢょ"},
-        {"にゃ","にゅ","にょ"},
-        {"ひゃ","ひゅ","ひょ"},
-        {"みゃ","みゅ","みょ"},
-        {"りゃ","りゅ","りょ"}
-    };
-
-    // Katakana
-    kata_gojuon = {
-        {"ア","イ","ウ","エ","オ"},
-        {"カ","キ","ク","ケ","コ"},
-        {"サ","シ","ス","セ","ソ"},
-        {"タ","チ","ツ","テ","ト"},
-        {"ナ","ニ","ヌ","ネ","ノ"},
-        {"ハ","ヒ","フ","ヘ","ホ"},
-        {"マ","ミ","ム","メ","モ"},
-        {"ヤ","","ユ","","ヨ"},
-        {"ラ","リ","ル","レ","ロ"},
-        {"ワ","","","","ヲ"},
-        {"","","ン","",""}
-    };
-
-    kata_dakuon = {
-        {"ガ","ギ","グ","ゲ","ゴ"},
-        {"ザ","ジ","ズ","ゼ","ゾ"},
-        {"ダ","ヂ","ヅ","デ","ド"}
-    };
-
-    kata_handakuon = {
-        {"バ","ビ","ブ","ベ","ボ"},
-        {"パ","ピ","プ","ペ","ポ"}
-    };
-
-    kata_yoon = {
-        {"キャ","キュ","キョ"},
-        {"ギャ","ギュ","ギョ"},
-        {"シャ","シュ","ショ"},
-        {"ジャ","ジュ","ジョ"},
-        {"チャ","チュ","チョ"},
-        {"ヂャ","ヂュ","ヂョ"},
-        {"ニャ","ニュ","ニョ"},
-        {"ヒャ","ヒュ","ヒョ"},
-        {"ミャ","ミュ","ミョ"},
-        {"リャ","リュ","リョ"}
-    };
-}
-
-
-// Refresh table
-void KanaTablePage::refreshTable()
-{
-    QLayoutItem *it;
-    while ((it = mainLayout->takeAt(0))) {
-        delete it->widget();
-        delete it;
-    }
-
-    bool isHira = btnHiragana->isChecked();
+    connect(grid, &KanaGridView::symbolClicked, this, &KanaTablePage::showDetail);
 
-    mainLayout->addWidget(createSection("Gojuon (basic)",
-                                        isHira ? hira_gojuon : kata_gojuon,
-                                        5));
+    // First paint after a toggle closes the measurement
+    connect(grid, &KanaGridView::painted, this, [this]() {
+        if (!m_measuring)
+            return;
 
-    mainLayout->addWidget(createSection("Dakuon",
-                                        isHira ? hira_dakuon : kata_dakuon,
-                                        5));
+        m_measuring = false;
+        m_lastToggleUs = m_toggleTimer.nsecsElapsed() / 1000;
 
-    mainLayout->addWidget(createSection("Handakuon",
-                                        isHira ? hira_handakuon : kata_handakuon,
-                                        5));
+        if (m_lastToggleUs > SLOW_TOGGLE_US)
+            qCDebug(lcTable) << "Kana table toggle took" << m_lastToggleUs << "us";
 
-    mainLayout->addWidget(createSection("Yoon",
-                                        isHira ? hira_yoon : kata_yoon,
-                                        3));
-
-    mainLayout->addStretch();
-}
-
-
-// Deleting ()
-static QString displayRomaji(QString s)
-{
-    s.remove(QRegularExpression(R"(\s*\([^)]*\))"));
-    return s.trimmed();
-}
-
-
-QWidget* KanaTablePage::createSection(const QString &title,
-                                      const QVector<QVector<QString>> &matrix,
-                                      int columns)
-{
-    QWidget *sec = new QWidget();
-    auto *V = new QVBoxLayout(sec);
-    V->setSpacing(12);
-
-    QLabel *lbl = new QLabel(title);
-    QFont f; f.setPointSize(16); f.setBold(true);
-    lbl->setFont(f);
-    lbl->setStyleSheet("color:white;");
-    V->addWidget(lbl);
-
-    QWidget *container = new QWidget();
-    auto *grid = new QGridLayout(container);
-    grid->setHorizontalSpacing(14);
-    grid->setVerticalSpacing(14);
-
-    int r = 0;
-    for (auto &row : matrix) {
-        for (int c = 0; c < columns; c++) {
-            if (c < row.size() && !row[c].isEmpty()) {
-                QString kana = row[c];
-                QString rom = romajiOf(kana);
-                grid->addWidget(createCard(kana, rom), r, c);
-            }
-        }
-        r++;
-    }
-
-    V->addWidget(container);
-    return sec;
+        emit toggleMeasured(grid->isHiragana(), m_lastToggleUs);
+    });
 }
 
 
-// Create Card
-QWidget* KanaTablePage::createCard(const QString &kana, const QString &romaji)
+// Script toggle (user action only, so startup painting is never measured)
+void KanaTablePage::showScript(bool isHira)
 {
-    QWidget *card = new QWidget();
-    card->setStyleSheet("background:#2a2a2a; border-radius:14px;");
-    card->setMinimumHeight(90);
+    KANA_TRACE_SCOPE("KanaTablePage::showScript");
 
-    auto *lay = new QVBoxLayout(card);
-    lay->setContentsMargins(0, 6, 0, 6);
+    if (grid->isHiragana() == isHira)
+        return;
 
-    QLabel *Lkana = new QLabel(kana);
-    QFont f; f.setPointSize(28); f.setBold(true);
-    Lkana->setFont(f);
-    Lkana->setAlignment(Qt::AlignCenter);
+    m_toggleTimer.start();
+    m_measuring = true;
 
-    QLabel *Lrom = new QLabel(displayRomaji(romaji));
-    Lrom->setStyleSheet("color:#bbbbbb; font-size:11pt;");
-    Lrom->setAlignment(Qt::AlignCenter);
-
-    lay->addWidget(Lkana);
-    lay->addWidget(Lrom);
-
-    card->setCursor(Qt::PointingHandCursor);
-    card->installEventFilter(this);
-
-    card->setProperty("kana", kana);
-    card->setProperty("romaji", romaji);
-
-    return card;
+    grid->setHiragana(isHira);
 }
 
 
-// Romaji dictionary
-QString KanaTablePage::romajiOf(const QString &k)
+// Detail
+void KanaTablePage::showDetail(int id, bool isHira)
 {
-    static QMap<QString, QString> R = {
-                                        // Hiragana
-                                        {"あ","a"},{"い","i"},{"う","u"},{"え","e"},{"お","o"},
-                                        {"か","ka"},{"き","ki"},{"く","ku"},{"け","ke"},{"こ","ko"},
-                                        {"さ","sa"},{"し","shi"},{"す","su"},{"せ","se"},{"そ","so"},
-                                        {"た","ta"},{"ち","chi"},{"つ","tsu"},{"て","te"},{"と","to"},
-                                        {"な","na"},{"に","ni"},{"ぬ","nu"},{"ね","ne"},{"の","no"},
-                                        {"は","ha"},{"ひ","hi"},{"ふ","fu"},{"へ","he"},{"ほ","ho"},
-                                        {"ま","ma"},{"み","mi"},{"む","mu"},{"め","me"},{"も","mo"},
-                                        {"や","ya"},{"ゆ","yu"},{"よ","yo"},
-                                        {"ら","ra"},{"り","ri"},{"る","ru"},{"れ","re"},{"ろ","ro"},
-                                        {"わ","wa"},{"を","wo"},{"ん","n"},
-
-                                        {"が","ga"},{"ぎ","gi"},{"ぐ","gu"},{"げ","ge"},{"ご","go"},
-                                        {"ざ","za"},{"じ","ji"},{"ず","zu"},{"ぜ","ze"},{"ぞ","zo"},
-                                        {"だ","da"},{"ぢ","ji(di)"},{"づ","zu(du)"},{"で","de"},{"ど","do"},
-                                        {"ば","ba"},{"び","bi"},{"ぶ","bu"},{"べ","be"},{"ぼ","bo"},
-                                        {"ぱ","pa"},{"ぴ","pi"},{"ぷ","pu"},{"ぺ","pe"},{"ぽ","po"},
-
-                                        {"きゃ","kya"},{"きゅ","kyu"},{"きょ","kyo"},
-                                        {"ぎゃ","gya"},{"ぎゅ","gyu"},{"ぎょ","gyo"},
-                                        {"しゃ","sha"},{"しゅ","shu"},{"しょ","sho"},
-                                        {"じゃ","ja"},{"じゅ","ju"},{"じょ","jo"},
-                                        {"ちゃ","cha"},{"ちゅ","chu"},{"ちょ","cho"},
-                                        {"ぢゃ","ja(chi)"},{"ぢゅ","ju(chi)"},{"ぢょ","jo(chi)"},
-                                        {"にゃ","nya"},{"にゅ","nyu"},{"にょ","nyo"},
-                                        {"ひゃ","hya"},{"ひゅ","hyu"},{"ひょ","hyo"},
-                                        {"みゃ","mya"},{"みゅ","myu"},{"みょ","myo"},
-                                        {"りゃ","rya"},{"りゅ","ryu"},{"りょ","ryo"},
-
-                                        // Katakana
-                                        {"ア","a"},{"イ","i"},{"ウ","u"},{"エ","e"},{"オ","o"},
-                                        {"カ","ka"},{"キ","ki"},{"ク","ku"},{"ケ","ke"},{"コ","ko"},
-                                        {"サ","sa"},{"シ","shi"},{"ス","su"},{"セ","se"},{"ソ","so"},
-                                        {"タ","ta"},{"チ","chi"},{"ツ","tsu"},{"テ","te"},{"ト","to"},
-                                        {"ナ","na"},{"ニ","ni"},{"ヌ","nu"},{"ネ","ne"},{"ノ","no"},
-                                        {"ハ","ha"},{"ヒ","hi"},{"フ","fu"},{"ヘ","he"},{"ホ","ho"},
-                                        {"マ","ma"},{"ミ","mi"},{"ム","mu"},{"メ","me"},{"モ","mo"},
-                                        {"ヤ","ya"},{"ユ","yu"},{"ヨ","yo"},
-                                        {"ラ","ra"},{"リ","ri"},{"ル","ru"},{"レ","re"},{"ロ","ro"},
-                                        {"ワ","wa"},{"ヲ","wo"},{"ン","n"},
-
-                                        {"ガ","ga"},{"ギ","gi"},{"グ","gu"},{"ゲ","ge"},{"ゴ","go"},
-                                        {"ザ","za"},{"ジ","ji"},{"ズ","zu"},{"ゼ","ze"},{"ゾ","zo"},
-                                        {"ダ","da"},{"ヂ","ji(di)"},{"ヅ","zu(du)"},{"デ","de"},{"ド","do"},
-                                        {"バ","ba"},{"ビ","bi"},{"ブ","bu"},{"ベ","be"},{"ボ","bo"},
-                                        {"パ","pa"},{"ピ","pi"},{"プ","pu"},{"ペ","pe"},{"ポ","po"},
-
-                                        {"キャ","kya"},{"キュ","kyu"},{"キョ","kyo"},
-                                        {"ギャ","gya"},{"ギュ","gyu"},{"ギョ","gyo"},
-                                        {"シャ","sha"},{"シュ","shu"},{"ショ","sho"},
-                                        {"ジャ","ja"},{"ジュ","ju"},{"ジョ","jo"},
-                                        {"チャ","cha"},{"チュ","chu"},{"チョ","cho"},
-                                        {"ヂャ","ja(chi)"},{"ヂュ","ju(chi)"},{"ヂョ","jo(chi)"},
-                                        {"ニャ","nya"},{"ニュ","nyu"},{"ニョ","nyo"},
-                                        {"ヒャ","hya"},{"ヒュ","hyu"},{"ヒョ","hyo"},
-                                        {"ミャ","mya"},{"ミュ","myu"},{"ミョ","myo"},
-                                        {"リャ","rya"},{"リュ","ryu"},{"リョ","ryo"},
-                                        };
-
-    return R.value(k, "");
-}
-
+    KANA_TRACE_SCOPE("KanaTablePage::showDetail");
 
-// Event filter
-bool KanaTablePage::eventFilter(QObject *obj, QEvent *ev)
-{
-    if (ev->type() == QEvent::MouseButtonRelease) {
-        QWidget *w = qobject_cast<QWidget*>(obj);
-        if (!w) return false;
-
-        QString kana   = w->property("kana").toString();
-        QString romaji = w->property("romaji").toString();
-
-        if (!kana.isEmpty()) {
-            bool isHira = btnHiragana->isChecked();
-            DetailDialog dlg(kana, romaji, isHira, this);
-            dlg.exec();
-        }
-    }
-    return false;
+    DetailDialog dlg(KanaCatalog::kana(id, isHira),
+                     KanaCatalog::romaji(id),
+                     isHira, this);
+    dlg.exec();
 }
@@ -2,10 +2,12 @@
 #define KANATABLEPAGE_H
 
 #include <QWidget>
+#include <QElapsedTimer>
+
+#include "kanacatalog.h"
 
 class QPushButton;
-class QScrollArea;
-class QVBoxLayout;
+class KanaGridView;
 
 class KanaTablePage : public QWidget
 {
@@ -14,8 +16,12 @@ class KanaTablePage : public QWidget
 public:
     explicit KanaTablePage(QWidget *parent = nullptr);
 
+    // Time from the last script toggle until the new table was painted
+    qint64 lastToggleLatencyUs() const { return m_lastToggleUs; }
+
 signals:
     void goHome();
+    void toggleMeasured(bool isHiragana, qint64 usecs);
 
 private:
     // UI
@@ -23,35 +29,19 @@ private:
     QPushButton *btnHiragana;
     QPushButton *btnKatakana;
 
-    QScrollArea *scrollArea;
-    QWidget     *scrollContent;
-    QVBoxLayout *mainLayout;
+    // Glyphs for both scripts are shaped up front, so a toggle is a flag
+    // flip and one repaint of this grid
+    KanaGridView *grid;
 
-    // Static tables
-    QVector<QVector<QString>> hira_gojuon;
-    QVector<QVector<QString>> hira_dakuon;
-    QVector<QVector<QString>> hira_handakuon;
-    QVector<QVector<QString>> hira_yoon;
-
-    QVector<QVector<QString>> kata_gojuon;
-    QVector<QVector<QString>> kata_dakuon;
-    QVector<QVector<QString>> kata_handakuon;
-    QVector<QVector<QString>> kata_yoon;
+    // Toggle latency
+    QElapsedTimer m_toggleTimer;
+    bool   m_measuring = false;
+    qint64 m_lastToggleUs = -1;
 
     // Methods
     void buildUi();
-    void loadStaticKana();
-    void refreshTable();
-
-    QWidget* createSection(const QString &title,
-                           const QVector<QVector<QString>> &matrix,
-                           int columns);
-
-    QWidget* createCard(const QString &kana, const QString &romaji);
-
-    QString romajiOf(const QString &kana);
-
-    bool eventFilter(QObject *obj, QEvent *ev) override;
+    void showScript(bool isHira);
+    void showDetail(int id, bool isHira);
 };
 
 #endif // KANATABLEPAGE_H
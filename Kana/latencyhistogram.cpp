@@ -0,0 +1,119 @@
+#include "latencyhistogram.h"
+
+#include <QtAlgorithms>
+
+#include <cmath>
+
+// Bucket layout
+int LatencyHistogram::bucketOf(int ms)
+{
+    const quint32 v = quint32(qBound(0, ms, MaxMs));
+    if (v < LinearBuckets)
+        return int(v);
+
+    // Magnitude m >= 6; the top six bits of v pick the sub-bucket
+    const int m = 31 - qCountLeadingZeroBits(v);
+    const int shift = m - 5;
+    return LinearBuckets + (m - 6) * SubBuckets + int(v >> shift) - SubBuckets;
+}
+
+int LatencyHistogram::lowestValue(int bucket)
+{
+    if (bucket < LinearBuckets)
+        return bucket;
+
+    const int group = (bucket - LinearBuckets) / SubBuckets;
+    const int sub   = (bucket - LinearBuckets) % SubBuckets + SubBuckets;
+    return sub << (group + 1);
+}
+
+
+// Recording
+void LatencyHistogram::record(int ms)
+{
+    if (ms < 0)
+        return;
+
+    const int b = bucketOf(ms);
+    if (b >= m_counts.size())
+        m_counts.resize(b + 1);
+
+    m_counts[b]++;
+    m_total++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (other.m_counts.size() > m_counts.size())
+        m_counts.resize(other.m_counts.size());
+
+    for (int b = 0; b < other.m_counts.size(); ++b)
+        m_counts[b] += other.m_counts[b];
+    m_total += other.m_total;
+}
+
+void LatencyHistogram::clear()
+{
+    m_counts.clear();
+    m_total = 0;
+}
+
+
+// Queries
+int LatencyHistogram::percentile(double p) const
+{
+    if (m_total == 0)
+        return -1;
+
+    // Rank of the value at p, 1-based, at least the first one
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, p, 100.0) / 100.0 * m_total)));
+
+    quint64 seen = 0;
+    for (int b = 0; b < m_counts.size(); ++b)
+    {
+        seen += m_counts[b];
+        if (seen >= rank)
+            return qMin(highestValue(b), MaxMs);
+    }
+    return MaxMs;
+}
+
+
+// JSON boundary
+QJsonArray LatencyHistogram::toJson() const
+{
+    QJsonArray a;
+
+    int last = 0;
+    for (int b = 0; b < m_counts.size(); ++b)
+    {
+        if (!m_counts[b])
+            continue;
+
+        a.append(b - last);
+        a.append(qint64(m_counts[b]));
+        last = b;
+    }
+    return a;
+}
+
+LatencyHistogram LatencyHistogram::fromJson(const QJsonArray &a)
+{
+    LatencyHistogram h;
+    const int maxBucket = bucketOf(MaxMs);
+
+    int b = 0;
+    for (int i = 0; i + 1 < a.size(); i += 2)
+    {
+        b += a[i].toInt();
+        const qint64 n = a[i + 1].toInteger();
+        if (b < 0 || b > maxBucket || n <= 0)
+            continue;
+
+        if (b >= h.m_counts.size())
+            h.m_counts.resize(b + 1);
+        h.m_counts[b] += quint32(n);
+        h.m_total += quint64(n);
+    }
+    return h;
+}
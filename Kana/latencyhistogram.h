@@ -0,0 +1,46 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QJsonArray>
+#include <QVector>
+#include <QtGlobal>
+
+// Response-time histogram in milliseconds, HDR style.
+//
+// Values below 64 ms get a bucket each; above that every power of two is
+// split into 32 linear sub-buckets, so any recorded value is known to
+// within ~3% up to the 10 minute cap. Histograms with the same layout
+// merge by adding counts, which is how per-symbol data rolls up into
+// per-script figures.
+class LatencyHistogram
+{
+public:
+    static constexpr int MaxMs = 10 * 60 * 1000;
+
+    void record(int ms);
+    void merge(const LatencyHistogram &other);
+    void clear();
+
+    bool    isEmpty() const { return m_total == 0; }
+    quint64 count() const { return m_total; }
+
+    // Highest value equivalent to the p-th percentile (0-100); -1 when empty
+    int percentile(double p) const;
+
+    // Sparse [bucket delta, count, ...] pairs for the stats snapshot
+    QJsonArray toJson() const;
+    static LatencyHistogram fromJson(const QJsonArray &a);
+
+private:
+    static constexpr int LinearBuckets = 64;
+    static constexpr int SubBuckets    = 32;
+
+    static int bucketOf(int ms);
+    static int lowestValue(int bucket);
+    static int highestValue(int bucket) { return lowestValue(bucket + 1) - 1; }
+
+    QVector<quint32> m_counts;    // grows to the highest bucket used
+    quint64          m_total = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -1,11 +1,30 @@
 #include "mainwindow.h"
+#include "trace.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    MainWindow::startStartupClock();
+
     QApplication a(argc, argv);
+    MainWindow::markStartup("application created");
+
+    // KANA_TRACE=<file> records spans and writes a Chrome trace on exit
+    const QString tracePath = qEnvironmentVariable("KANA_TRACE");
+    if (!tracePath.isEmpty())
+        Trace::instance()->setEnabled(true);
+
+    StallWatchdog watchdog;
+    watchdog.start();
+
     MainWindow w;
     w.show();
-    return a.exec();
+    const int rc = a.exec();
+
+    watchdog.stop();
+    if (!tracePath.isEmpty())
+        Trace::instance()->exportChromeTrace(tracePath);
+
+    return rc;
 }
@@ -4,8 +4,35 @@
 #include "homepage.h"
 #include "kanatablepage.h"
 #include "practicesetuppage.h"
-#include "practicesessionpage.h"
-#include "statisticspage.h"
+#include "PracticeSessionPage.h"
+#include "StatisticsPage.h"
+#include "progressmanager.h"
+#include "trace.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QEvent>
+#include <QLoggingCategory>
+
+// Startup and page timings; QT_LOGGING_RULES="kana.startup.debug=true" shows them
+Q_LOGGING_CATEGORY(lcStartup, "kana.startup", QtWarningMsg)
+
+namespace
+{
+    QElapsedTimer &startupClock()
+    {
+        static QElapsedTimer clock;
+        return clock;
+    }
+
+    const char *pageName(MainWindow::Page page)
+    {
+        static const char *names[] = {
+            "home", "kana table", "practice setup", "practice session", "statistics"
+        };
+        return names[int(page)];
+    }
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -14,63 +41,157 @@ MainWindow::MainWindow(QWidget *parent)
     ui->setupUi(this);
     setFixedSize(800, 600);
 
-    // Pages
-    auto *homePage = new HomePage(this);
-    auto *kanaTablePage = new KanaTablePage(this);
-    auto *practiceSetupPage = new PracticeSetupPage(this);
-    auto *practiceSessionPage = new PracticeSessionPage(this);
-    auto *statisticsPage = new StatisticsPage(this);
-
-    auto *stack = ui->stackedWidget;
-    stack->addWidget(homePage);
-    stack->addWidget(kanaTablePage);
-    stack->addWidget(practiceSetupPage);
-    stack->addWidget(practiceSessionPage);
-    stack->addWidget(statisticsPage);
-
-    stack->setCurrentWidget(homePage);
-
-    // Home
-    connect(homePage, &HomePage::openKanaTable, this, [=]() {
-        stack->setCurrentWidget(kanaTablePage);
-    });
-
-    connect(homePage, &HomePage::openPractice, this, [=]() {
-        stack->setCurrentWidget(practiceSetupPage);
-    });
-
-    connect(homePage, &HomePage::openStatistics, this, [=]() {
-        statisticsPage->loadStats();
-        stack->setCurrentWidget(statisticsPage);
-    });
-
-    // Practice
-    connect(practiceSetupPage, &PracticeSetupPage::startPractice,
-            this, [=](const PracticeConfig &config) {
-                practiceSessionPage->startSession(config);
-                stack->setCurrentWidget(practiceSessionPage);
-            });
-
-    connect(practiceSessionPage, &PracticeSessionPage::backToSetup,
-            this, [=]() {
-                stack->setCurrentWidget(practiceSetupPage);
-            });
-
-    // Back to Home
-    connect(kanaTablePage, &KanaTablePage::goHome, this, [=]() {
-        stack->setCurrentWidget(homePage);
-    });
-
-    connect(practiceSetupPage, &PracticeSetupPage::goHome, this, [=]() {
-        stack->setCurrentWidget(homePage);
-    });
-
-    connect(statisticsPage, &StatisticsPage::goHome, this, [=]() {
-        stack->setCurrentWidget(homePage);
-    });
+    // Placeholder pages from the .ui file
+    while (ui->stackedWidget->count() > 0)
+        delete ui->stackedWidget->widget(0);
+
+    registerPages();
+    showPage(Page::Home);
+
+    installEventFilter(this);
+    markStartup("main window constructed");
 }
 
 MainWindow::~MainWindow()
 {
     delete ui;
 }
+
+// Startup timing
+
+void MainWindow::startStartupClock()
+{
+    startupClock().start();
+}
+
+void MainWindow::markStartup(const char *stage)
+{
+    if (startupClock().isValid())
+        qCDebug(lcStartup).nospace() << "Startup: " << stage << " at "
+                                     << startupClock().elapsed() << " ms";
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == this && event->type() == QEvent::Paint && m_firstPaint)
+    {
+        m_firstPaint = false;
+        removeEventFilter(this);
+
+        // The children are painted and the frame flushed within this same
+        // repaint; the queued call runs right after it
+        QTimer::singleShot(0, this, []() { markStartup("first frame"); });
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+// Pages
+
+void MainWindow::registerPages()
+{
+    m_factories[int(Page::Home)] = [this]() -> QWidget * {
+        auto *p = new HomePage(this);
+        connect(p, &HomePage::openKanaTable, this, [this]() {
+            showPage(Page::KanaTable);
+        });
+        connect(p, &HomePage::openPractice, this, [this]() {
+            showPage(Page::PracticeSetup);
+        });
+        connect(p, &HomePage::openStatistics, this, [this]() {
+            statisticsPage()->loadStats();
+            showPage(Page::Statistics);
+        });
+        return p;
+    };
+
+    m_factories[int(Page::KanaTable)] = [this]() -> QWidget * {
+        auto *p = new KanaTablePage(this);
+        connect(p, &KanaTablePage::goHome, this, [this]() {
+            showPage(Page::Home);
+        });
+        return p;
+    };
+
+    m_factories[int(Page::PracticeSetup)] = [this]() -> QWidget * {
+        auto *p = new PracticeSetupPage(this);
+        connect(p, &PracticeSetupPage::startPractice,
+                this, [this](const PracticeConfig &config) {
+                    practiceSessionPage()->startSession(config);
+                    showPage(Page::PracticeSession);
+                });
+        connect(p, &PracticeSetupPage::goHome, this, [this]() {
+            showPage(Page::Home);
+        });
+        return p;
+    };
+
+    m_factories[int(Page::PracticeSession)] = [this]() -> QWidget * {
+        auto *p = new PracticeSessionPage(progress(), this);
+        connect(p, &PracticeSessionPage::backToSetup,
+                this, [this]() {
+                    showPage(Page::PracticeSetup);
+                });
+        return p;
+    };
+
+    m_factories[int(Page::Statistics)] = [this]() -> QWidget * {
+        auto *p = new StatisticsPage(progress(), this);
+        connect(p, &StatisticsPage::goHome, this, [this]() {
+            showPage(Page::Home);
+        });
+        return p;
+    };
+}
+
+ProgressManager *MainWindow::progress()
+{
+    if (!m_progress)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        m_progress = new ProgressManager(this);
+
+        qCDebug(lcStartup).nospace() << "Loaded progress in " << timer.elapsed() << " ms";
+    }
+    return m_progress;
+}
+
+bool MainWindow::isCreated(Page page) const
+{
+    return m_pages[int(page)] != nullptr;
+}
+
+QWidget *MainWindow::page(Page page)
+{
+    KANA_TRACE_SCOPE("MainWindow::page");
+
+    QWidget *&slot = m_pages[int(page)];
+    if (slot)
+        return slot;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    slot = m_factories[int(page)]();
+    ui->stackedWidget->addWidget(slot);
+
+    qCDebug(lcStartup).nospace() << "Created " << pageName(page) << " page in "
+                                 << timer.elapsed() << " ms";
+    return slot;
+}
+
+void MainWindow::showPage(Page page)
+{
+    ui->stackedWidget->setCurrentWidget(this->page(page));
+}
+
+PracticeSessionPage *MainWindow::practiceSessionPage()
+{
+    return static_cast<PracticeSessionPage *>(page(Page::PracticeSession));
+}
+
+StatisticsPage *MainWindow::statisticsPage()
+{
+    return static_cast<StatisticsPage *>(page(Page::Statistics));
+}
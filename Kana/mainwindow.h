@@ -2,14 +2,14 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
-class KanaTablePage;
-class PracticeSetupPage;
 class PracticeSessionPage;
+class ProgressManager;
 class StatisticsPage;
 
 class MainWindow : public QMainWindow
@@ -17,12 +17,38 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
+    enum class Page { Home, KanaTable, PracticeSetup, PracticeSession, Statistics, Count };
+
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Startup clock, started as early as possible in main()
+    static void startStartupClock();
+    static void markStartup(const char *stage);
+
+    // Built on first use; nothing but the home page exists at startup
+    bool isCreated(Page page) const;
+    QWidget *page(Page page);
+    void showPage(Page page);
+
+protected:
+    // Marks the first painted frame of the window
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
+    void registerPages();
+    ProgressManager *progress();
+
+    PracticeSessionPage *practiceSessionPage();
+    StatisticsPage      *statisticsPage();
+
     Ui::MainWindow *ui;
+
+    static constexpr int PageCount = int(Page::Count);
+    std::function<QWidget *()> m_factories[PageCount];
+    QWidget *m_pages[PageCount] = {};
+    ProgressManager *m_progress = nullptr;   // shared by the pages, loaded on first use
+    bool m_firstPaint = true;
 };
 
 #endif // MAINWINDOW_H
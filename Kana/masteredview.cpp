@@ -0,0 +1,194 @@
+#include "masteredview.h"
+#include "kanacatalog.h"
+#include "trace.h"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <algorithm>
+
+// Layout (matches the old card widgets)
+static const int CARD_WIDTH   = 72;
+static const int CARD_HEIGHT  = 86;
+static const int CARD_SPACING = 12;
+static const int CARD_RADIUS  = 12;
+
+static const QColor CARD_COLOR   ("#2b2b2b");
+static const QColor KANA_COLOR   (Qt::white);
+static const QColor ROMAJI_COLOR ("#bbbbbb");
+
+
+MasteredView::MasteredView(bool isHiragana, QWidget *parent)
+    : QWidget(parent)
+    , m_isHiragana(isHiragana)
+{
+    QSizePolicy policy(QSizePolicy::Preferred, QSizePolicy::Preferred);
+    policy.setHeightForWidth(true);
+    setSizePolicy(policy);
+
+    m_kanaFont.setPointSize(26);
+    m_romajiFont.setPointSize(10);
+
+    m_kana.resize(KanaCatalog::Count);
+    m_romaji.resize(KanaCatalog::Count);
+    m_prepared.fill(false, KanaCatalog::Count);
+}
+
+
+// Diffing: only cards from the first difference on change place
+void MasteredView::setMastered(const QVector<int> &ids)
+{
+    QVector<int> sorted;
+    sorted.reserve(ids.size());
+    for (int id : ids)
+        if (KanaCatalog::isValid(id))
+            sorted.append(id);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    if (sorted == m_ids)
+        return;
+
+    const auto diff = std::mismatch(m_ids.cbegin(), m_ids.cend(),
+                                    sorted.cbegin(), sorted.cend());
+    const int first = int(diff.first - m_ids.cbegin());
+    const int oldCount = m_ids.size();
+
+    m_ids = sorted;
+    changedFrom(first, oldCount);
+}
+
+void MasteredView::setSymbolMastered(int id, bool mastered)
+{
+    if (!KanaCatalog::isValid(id))
+        return;
+
+    auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+    const bool present = it != m_ids.end() && *it == id;
+    if (present == mastered)
+        return;
+
+    const int index = int(it - m_ids.begin());
+    const int oldCount = m_ids.size();
+
+    if (mastered)
+        m_ids.insert(index, id);
+    else
+        m_ids.remove(index);
+
+    changedFrom(index, oldCount);
+}
+
+void MasteredView::changedFrom(int index, int oldCount)
+{
+    const int columns = columnsFor(width());
+    const int rowsBefore = (oldCount + columns - 1) / columns;
+    const int rowsAfter  = (m_ids.size() + columns - 1) / columns;
+
+    if (rowsBefore != rowsAfter)
+        updateGeometry();
+
+    // Cards before `index` did not move
+    const QRect from = cellRect(index, columns);
+    update(QRect(0, from.top(), width(), height() - from.top()));
+}
+
+
+// Layout
+int MasteredView::columnsFor(int width) const
+{
+    return qMax(1, (width + CARD_SPACING) / (CARD_WIDTH + CARD_SPACING));
+}
+
+QRect MasteredView::cellRect(int index, int columns) const
+{
+    return QRect((index % columns) * (CARD_WIDTH + CARD_SPACING),
+                 (index / columns) * (CARD_HEIGHT + CARD_SPACING),
+                 CARD_WIDTH, CARD_HEIGHT);
+}
+
+int MasteredView::heightForWidth(int width) const
+{
+    const int columns = columnsFor(width);
+    const int rows = (m_ids.size() + columns - 1) / columns;
+    return rows ? rows * CARD_HEIGHT + (rows - 1) * CARD_SPACING : 0;
+}
+
+QSize MasteredView::sizeHint() const
+{
+    const int w = 8 * CARD_WIDTH + 7 * CARD_SPACING;
+    return QSize(w, heightForWidth(w));
+}
+
+
+// Painting: only rows intersecting the exposed rect
+void MasteredView::prepareGlyphs(int id)
+{
+    if (m_prepared[id])
+        return;
+
+    auto prepare = [](QStaticText &st, const QString &text, const QFont &font) {
+        st.setText(text);
+        st.setTextFormat(Qt::PlainText);
+        st.setPerformanceHint(QStaticText::AggressiveCaching);
+        st.prepare(QTransform(), font);
+    };
+
+    prepare(m_kana[id], KanaCatalog::kana(id, m_isHiragana), m_kanaFont);
+    prepare(m_romaji[id], KanaCatalog::displayRomaji(id), m_romajiFont);
+    m_prepared[id] = true;
+}
+
+void MasteredView::paintEvent(QPaintEvent *ev)
+{
+    KANA_TRACE_SCOPE("MasteredView::paintEvent");
+
+    if (m_ids.isEmpty())
+        return;
+
+    const int columns = columnsFor(width());
+    const int pitch = CARD_HEIGHT + CARD_SPACING;
+    const QRect r = ev->rect();
+
+    const int first = qMax(0, r.top() / pitch) * columns;
+    const int last  = qMin(m_ids.size(), (r.bottom() / pitch + 1) * columns);
+    if (first >= last)
+        return;
+
+    for (int i = first; i < last; ++i)
+        prepareGlyphs(m_ids[i]);
+
+    QPainter p(this);
+    p.setRenderHint(QPainter::Antialiasing);
+
+    p.setPen(Qt::NoPen);
+    p.setBrush(CARD_COLOR);
+    for (int i = first; i < last; ++i)
+        p.drawRoundedRect(cellRect(i, columns), CARD_RADIUS, CARD_RADIUS);
+
+    auto blockTop = [&](const QRect &c, int id) {
+        const qreal h = m_kana[id].size().height() + m_romaji[id].size().height();
+        return c.center().y() - h / 2;
+    };
+
+    // One pass per font so the painter never re-resolves fonts per card
+    p.setFont(m_kanaFont);
+    p.setPen(KANA_COLOR);
+    for (int i = first; i < last; ++i)
+    {
+        const QRect c = cellRect(i, columns);
+        const QStaticText &st = m_kana[m_ids[i]];
+        p.drawStaticText(QPointF(c.x() + (c.width() - st.size().width()) / 2,
+                                 blockTop(c, m_ids[i])), st);
+    }
+
+    p.setFont(m_romajiFont);
+    p.setPen(ROMAJI_COLOR);
+    for (int i = first; i < last; ++i)
+    {
+        const QRect c = cellRect(i, columns);
+        const int id = m_ids[i];
+        const QStaticText &st = m_romaji[id];
+        p.drawStaticText(QPointF(c.x() + (c.width() - st.size().width()) / 2,
+                                 blockTop(c, id) + m_kana[id].size().height()), st);
+    }
+}
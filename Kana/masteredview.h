@@ -0,0 +1,49 @@
+#ifndef MASTEREDVIEW_H
+#define MASTEREDVIEW_H
+
+#include <QWidget>
+#include <QVector>
+#include <QStaticText>
+#include <QFont>
+
+// Mastered symbols of one script as a painted, wrapping grid of cards.
+// Cells have a fixed size, so the rows to paint come straight from the
+// exposed rect; glyphs are shaped the first time a card is painted.
+// setMastered() / setSymbolMastered() diff against what is shown and only
+// repaint the cards that moved.
+class MasteredView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MasteredView(bool isHiragana, QWidget *parent = nullptr);
+
+    // Catalog ids, any order
+    void setMastered(const QVector<int> &ids);
+    void setSymbolMastered(int id, bool mastered);
+    int  count() const { return m_ids.size(); }
+
+    bool hasHeightForWidth() const override { return true; }
+    int  heightForWidth(int width) const override;
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *ev) override;
+
+private:
+    int   columnsFor(int width) const;
+    QRect cellRect(int index, int columns) const;
+    void  changedFrom(int index, int oldCount);
+    void  prepareGlyphs(int id);
+
+    bool m_isHiragana;
+    QVector<int> m_ids;              // sorted catalog ids
+
+    QFont m_kanaFont;
+    QFont m_romajiFont;
+    QVector<QStaticText> m_kana;     // per catalog id, shaped lazily
+    QVector<QStaticText> m_romaji;
+    QVector<bool>        m_prepared;
+};
+
+#endif // MASTEREDVIEW_H
@@ -3,14 +3,22 @@
 
 struct PracticeConfig
 {
-    enum class Mode   { KanaToRomaji, RomajiToKana, Mixed };
+    enum class Mode   { KanaToRomaji, RomajiToKana, Mixed, AudioToKana };
     enum class Script { Hiragana, Katakana, Both };
-    enum class Source { All, Mastered};
+    enum class Source { All, Mastered, Due, Confused };
+    enum class Distractors { Random, LookAlike };
 
     Mode   mode   = Mode::Mixed;
     Script script = Script::Both;
     Source source = Source::All;
+    Distractors distractors = Distractors::Random;
     int questionLimit = -1;
+
+    // Speed drill: > 0 runs against the clock for this many seconds, with
+    // no transitions and no question limit
+    int timeBudgetSecs = 0;
+
+    bool isDrill() const { return timeBudgetSecs > 0; }
 };
 
 #endif // PRACTICECONFIG_H
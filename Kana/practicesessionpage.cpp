@@ -1,18 +1,23 @@
-#include "practicesessionpage.h"
+#include "PracticeSessionPage.h"
+#include "kanacatalog.h"
+#include "audioservice.h"
+#include "trace.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
 #include <QLabel>
 #include <QPushButton>
-#include <QRandomGenerator>
 #include <QGraphicsOpacityEffect>
 #include <QPropertyAnimation>
 #include <QEasingCurve>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QFile>
+#include <QKeyEvent>
+#include <QTimer>
+#include <functional>
+#include <utility>
+
+// A wrong drill answer stays up this long before the next question
+static const int DRILL_WRONG_PAUSE_MS = 600;
 
 // tyles
 
@@ -59,45 +64,52 @@ static QString optionStyleWrong()
 }
 
 
-PracticeSessionPage::PracticeSessionPage(QWidget *parent)
+PracticeSessionPage::PracticeSessionPage(ProgressManager *progress, QWidget *parent)
     : QWidget(parent)
+    , progress(progress)
 {
-    progress = new ProgressManager(this);
     buildUi();
-    buildKanaPool();
 }
 
 
 // Start Session
 void PracticeSessionPage::startSession(const PracticeConfig &config)
 {
+    KANA_TRACE_SCOPE("PracticeSessionPage::startSession");
+
     m_config = config;
-    btnStop->setVisible(m_config.questionLimit == -1);
-    m_pool.clear();
+    btnStop->setVisible(m_config.questionLimit == -1 || m_config.isDrill());
 
-    if (m_config.source == PracticeConfig::Source::Mastered)
-        loadMasteredFromStats();
+    advanceTimer->stop();
+    drillTick->stop();
+    m_bufferedAnswer = -1;
 
-    for (const auto &it : m_all)
+    // Listening needs a clip for every question
+    std::function<bool(const QuizKanaItem &)> keep;
+    if (m_config.mode == PracticeConfig::Mode::AudioToKana)
     {
-        if (m_config.script == PracticeConfig::Script::Hiragana && !it.isHiragana)
-            continue;
-        if (m_config.script == PracticeConfig::Script::Katakana && it.isHiragana)
-            continue;
-
-        if (m_config.source == PracticeConfig::Source::Mastered)
-        {
-            if (!m_masteredRomaji.contains(it.romaji))
-                continue;
-        }
-
-        m_pool.append(it);
+        AudioService *audio = AudioService::instance();
+        keep = [audio](const QuizKanaItem &it) { return audio->hasClip(it.id); };
     }
 
-    if (m_pool.isEmpty())
+    if (m_engine.start(m_config, progress, keep) == 0)
     {
-        lblQuestion->setText("No mastered symbols yet");
-        lblSubtitle->setText("Practice some symbols first");
+        if (m_config.source == PracticeConfig::Source::Confused)
+        {
+            lblQuestion->setText("No mistakes recorded yet");
+            lblSubtitle->setText("Practice some symbols first");
+        }
+        else if (m_config.source == PracticeConfig::Source::Mastered)
+        {
+            lblQuestion->setText("No mastered symbols yet");
+            lblSubtitle->setText("Practice some symbols first");
+        }
+        else
+        {
+            lblQuestion->setText("No sound clips found");
+            lblSubtitle->setText("No audio clips are installed (data/sounds)");
+        }
+        btnReplay->hide();
 
         for (auto b : opt)
             b->hide();
@@ -109,14 +121,17 @@ void PracticeSessionPage::startSession(const PracticeConfig &config)
 
     m_questionIndex = 0;
     m_correctCount = 0;
+    m_answered = 0;
     m_active = false;
+    m_prepared.ready = false;
+    m_current = QuizKanaItem();
 
     resultWidget->hide();
     btnHome->show();
     lblFeedback->show();
     lblQuestion->show();
     lblSubtitle->show();
-    btnNext->show();
+    btnNext->setVisible(!m_config.isDrill());
 
     for (auto b : opt)
         b->show();
@@ -125,12 +140,21 @@ void PracticeSessionPage::startSession(const PracticeConfig &config)
     fadeOut->stop();
     fadeIn->stop();
 
+    if (m_config.isDrill())
+    {
+        m_drillClock.start();
+        drillTick->start();
+    }
+
+    setFocus();
     askQuestion();
 }
 
 // UI
 void PracticeSessionPage::buildUi()
 {
+    setFocusPolicy(Qt::StrongFocus);
+
     auto *root = new QVBoxLayout(this);
     root->setContentsMargins(16, 16, 16, 16);
     root->setSpacing(16);
@@ -138,6 +162,7 @@ void PracticeSessionPage::buildUi()
     // Top bar
     auto *top = new QHBoxLayout();
     btnHome = new QPushButton("← Back");
+    btnHome->setObjectName("backButton");
     btnHome->setStyleSheet(
         "QPushButton { padding:6px 14px; background:#444;"
         "color:white; border-radius:6px; }"
@@ -167,6 +192,18 @@ void PracticeSessionPage::buildUi()
     lblSubtitle->setStyleSheet("color:#bbbbbb; font-size:13pt;");
     root->addWidget(lblSubtitle);
 
+    btnReplay = new QPushButton("Play again");
+    btnReplay->setStyleSheet(
+        "QPushButton { padding:6px 14px; background:#444;"
+        "color:white; border-radius:6px; }"
+        "QPushButton:hover { background:#555; }"
+        );
+    btnReplay->hide();
+    connect(btnReplay, &QPushButton::clicked, this, [this]() {
+        AudioService::instance()->play(m_current.id);
+    });
+    root->addWidget(btnReplay, 0, Qt::AlignCenter);
+
     // Fade animation
     opacity = new QGraphicsOpacityEffect(this);
     lblQuestion->setGraphicsEffect(opacity);
@@ -186,6 +223,21 @@ void PracticeSessionPage::buildUi()
         fadeIn->start();
     });
 
+    // Response time counts from the question being fully visible
+    connect(fadeIn, &QPropertyAnimation::finished, this, [this]() {
+        if (m_active)
+            m_answerTimer.start();
+    });
+
+    // Speed drill
+    advanceTimer = new QTimer(this);
+    advanceTimer->setSingleShot(true);
+    connect(advanceTimer, &QTimer::timeout, this, &PracticeSessionPage::askQuestion);
+
+    drillTick = new QTimer(this);
+    drillTick->setInterval(100);
+    connect(drillTick, &QTimer::timeout, this, &PracticeSessionPage::updateDrillClock);
+
     // Grid of options
     auto *grid = new QGridLayout();
     grid->setSpacing(16);
@@ -193,6 +245,7 @@ void PracticeSessionPage::buildUi()
     for (int i = 0; i < 4; ++i)
     {
         opt[i] = new QPushButton("...");
+        opt[i]->setObjectName(QString("option%1").arg(i));
         opt[i]->setStyleSheet(optionStyleNormal());
         opt[i]->setMinimumHeight(65);
         opt[i]->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
@@ -211,6 +264,8 @@ void PracticeSessionPage::buildUi()
     root->addWidget(lblFeedback);
 
     btnNext = new QPushButton("Next");
+    btnNext->setObjectName("nextButton");
+
     btnNext->setEnabled(false);
     btnNext->setMinimumHeight(50);
     btnNext->setStyleSheet(
@@ -245,6 +300,7 @@ void PracticeSessionPage::buildUi()
     r->addStretch();
 
     btnBack = new QPushButton("Back to Setup");
+    btnBack->setObjectName("setupButton");
     btnBack->setStyleSheet(
         "QPushButton { background:#f7a027; color:black; padding:12px 24px;"
         "border-radius:14px; font-size:15pt; }"
@@ -259,306 +315,84 @@ void PracticeSessionPage::buildUi()
 }
 
 
-// Kana pool
-void PracticeSessionPage::buildKanaPool()
-{
-    m_all.clear();
-
-    auto addKana = [&](const QString &kana, bool hira)
-    {
-        if (kana.isEmpty()) return;
-        QuizKanaItem it;
-        it.kana = kana;
-        it.romaji = romajiOf(kana);
-        it.isHiragana = hira;
-        if (!it.romaji.isEmpty())
-            m_all.append(it);
-    };
-
-    // Hiragana
-    const QVector<QVector<QString>> hira_gojuon = {
-        {"あ","い","う","え","お"},
-        {"か","き","く","け","こ"},
-        {"さ","し","す","せ","そ"},
-        {"た","ち","つ","て","と"},
-        {"な","に","ぬ","ね","の"},
-        {"は","ひ","ふ","へ","ほ"},
-        {"ま","み","む","め","も"},
-        {"や","","ゆ","","よ"},
-        {"ら","り","る","れ","ろ"},
-        {"わ","","","","を"},
-        {"","","ん","",""}
-    };
-
-    const QVector<QVector<QString>> hira_dakuon = {
-        {"が","ぎ","ぐ","げ","ご"},
-        {"ざ","じ","ず","ぜ","ぞ"},
-        {"だ","ぢ","づ","で","ど"}
-    };
-
-    const QVector<QVector<QString>> hira_handakuon = {
-        {"ば","び","ぶ","べ","ぼ"},
-        {"ぱ","ぴ","ぷ","ぺ","ぽ"}
-    };
-
-    const QVector<QVector<QString>> hira_yoon = {
-        {"きゃ","きゅ","きょ"},
-        {"ぎゃ","ぎゅ","ぎょ"},
-        {"しゃ","しゅ","しょ"},
-        {"じゃ","じゅ","じょ"},
-        {"ちゃ","ちゅ","ちょ"},
-        {"にゃ","にゅ","にょ"},
-        {"ひゃ","ひゅ","ひょ"},
-        {"みゃ","みゅ","みょ"},
-        {"りゃ","りゅ","りょ"}
-    };
-
-    auto addMatrix = [&](const QVector<QVector<QString>> &m, bool hira) {
-        for (auto &row : m)
-            for (auto &k : row)
-                addKana(k, hira);
-    };
-
-    addMatrix(hira_gojuon, true);
-    addMatrix(hira_dakuon, true);
-    addMatrix(hira_handakuon, true);
-    addMatrix(hira_yoon, true);
-
-    // Katakana
-    const QVector<QVector<QString>> kata_gojuon = {
-        {"ア","イ","ウ","エ","オ"},
-        {"カ","キ","ク","ケ","コ"},
-        {"サ","シ","ス","セ","ソ"},
-        {"タ","チ","ツ","テ","ト"},
-        {"ナ","ニ","ヌ","ネ","ノ"},
-        {"ハ","ヒ","フ","ヘ","ホ"},
-        {"マ","ミ","ム","メ","モ"},
-        {"ヤ","","ユ","","ヨ"},
-        {"ラ","リ","ル","レ","ロ"},
-        {"ワ","","","","ヲ"},
-        {"","","ン","",""}
-    };
-
-    const QVector<QVector<QString>> kata_dakuon = {
-        {"ガ","ギ","グ","ゲ","ゴ"},
-        {"ザ","ジ","ズ","ゼ","ゾ"},
-        {"ダ","ヂ","ヅ","デ","ド"}
-    };
-
-    const QVector<QVector<QString>> kata_handakuon = {
-        {"バ","ビ","ブ","ベ","ボ"},
-        {"パ","ピ","プ","ペ","ポ"}
-    };
-
-    const QVector<QVector<QString>> kata_yoon = {
-        {"キャ","キュ","キョ"},
-        {"ギャ","ギュ","ギョ"},
-        {"シャ","シュ","ショ"},
-        {"ジャ","ジュ","ジョ"},
-        {"チャ","チュ","チョ"},
-        {"ニャ","ニュ","ニョ"},
-        {"ヒャ","ヒュ","ヒョ"},
-        {"ミャ","ミュ","ミョ"},
-        {"リャ","リュ","リョ"}
-    };
-
-    addMatrix(kata_gojuon, false);
-    addMatrix(kata_dakuon, false);
-    addMatrix(kata_handakuon, false);
-    addMatrix(kata_yoon, false);
-}
-
-// romajiOf
-QString PracticeSessionPage::romajiOf(const QString &k)
-{
-    static QMap<QString, QString> R = {
-                                       // Hiragana
-                                       {"あ","a"},{"い","i"},{"う","u"},{"え","e"},{"お","o"},
-                                       {"か","ka"},{"き","ki"},{"く","ku"},{"け","ke"},{"こ","ko"},
-                                       {"さ","sa"},{"し","shi"},{"す","su"},{"せ","se"},{"そ","so"},
-                                       {"た","ta"},{"ち","chi"},{"つ","tsu"},{"て","te"},{"と","to"},
-                                       {"な","na"},{"に","ni"},{"ぬ","nu"},{"ね","ne"},{"の","no"},
-                                       {"は","ha"},{"ひ","hi"},{"ふ","fu"},{"へ","he"},{"ほ","ho"},
-                                       {"ま","ma"},{"み","mi"},{"む","mu"},{"め","me"},{"も","mo"},
-                                       {"や","ya"},{"ゆ","yu"},{"よ","yo"},
-                                       {"ら","ra"},{"り","ri"},{"る","ru"},{"れ","re"},{"ろ","ro"},
-                                       {"わ","wa"},{"を","wo"},{"ん","n"},
-
-                                       {"が","ga"},{"ぎ","gi"},{"ぐ","gu"},{"げ","ge"},{"ご","go"},
-                                       {"ざ","za"},{"じ","ji"},{"ず","zu"},{"ぜ","ze"},{"ぞ","zo"},
-                                       {"だ","da"},{"ぢ","ji(di)"},{"づ","zu(du)"},{"で","de"},{"ど","do"},
-                                       {"ば","ba"},{"び","bi"},{"ぶ","bu"},{"べ","be"},{"ぼ","bo"},
-                                       {"ぱ","pa"},{"ぴ","pi"},{"ぷ","pu"},{"ぺ","pe"},{"ぽ","po"},
-
-                                       {"きゃ","kya"},{"きゅ","kyu"},{"きょ","kyo"},
-                                       {"ぎゃ","gya"},{"ぎゅ","gyu"},{"ぎょ","gyo"},
-                                       {"しゃ","sha"},{"しゅ","shu"},{"しょ","sho"},
-                                       {"じゃ","ja"},{"じゅ","ju"},{"じょ","jo"},
-                                       {"ちゃ","cha"},{"ちゅ","chu"},{"ちょ","cho"},
-                                       {"ぢゃ","ja(chi)"},{"ぢゅ","ju(chi)"},{"ぢょ","jo(chi)"},
-                                       {"にゃ","nya"},{"にゅ","nyu"},{"にょ","nyo"},
-                                       {"ひゃ","hya"},{"ひゅ","hyu"},{"ひょ","hyo"},
-                                       {"みゃ","mya"},{"みゅ","myu"},{"みょ","myo"},
-                                       {"りゃ","rya"},{"りゅ","ryu"},{"りょ","ryo"},
-
-                                       // Katakana
-                                       {"ア","a"},{"イ","i"},{"ウ","u"},{"エ","e"},{"オ","o"},
-                                       {"カ","ka"},{"キ","ki"},{"ク","ku"},{"ケ","ke"},{"コ","ko"},
-                                       {"サ","sa"},{"シ","shi"},{"ス","su"},{"セ","se"},{"ソ","so"},
-                                       {"タ","ta"},{"チ","chi"},{"ツ","tsu"},{"テ","te"},{"ト","to"},
-                                       {"ナ","na"},{"ニ","ni"},{"ヌ","nu"},{"ネ","ne"},{"ノ","no"},
-                                       {"ハ","ha"},{"ヒ","hi"},{"フ","fu"},{"ヘ","he"},{"ホ","ho"},
-                                       {"マ","ma"},{"ミ","mi"},{"ム","mu"},{"メ","me"},{"モ","mo"},
-                                       {"ヤ","ya"},{"ユ","yu"},{"ヨ","yo"},
-                                       {"ラ","ra"},{"リ","ri"},{"ル","ru"},{"レ","re"},{"ロ","ro"},
-                                       {"ワ","wa"},{"ヲ","wo"},{"ン","n"},
-
-                                       {"ガ","ga"},{"ギ","gi"},{"グ","gu"},{"ゲ","ge"},{"ゴ","go"},
-                                       {"ザ","za"},{"ジ","ji"},{"ズ","zu"},{"ゼ","ze"},{"ゾ","zo"},
-                                       {"ダ","da"},{"ヂ","ji(di)"},{"ヅ","zu(du)"},{"デ","de"},{"ド","do"},
-                                       {"バ","ba"},{"ビ","bi"},{"ブ","bu"},{"ベ","be"},{"ボ","bo"},
-                                       {"パ","pa"},{"ピ","pi"},{"プ","pu"},{"ペ","pe"},{"ポ","po"},
-
-                                       {"キャ","kya"},{"キュ","kyu"},{"キョ","kyo"},
-                                       {"ギャ","gya"},{"ギュ","gyu"},{"ギョ","gyo"},
-                                       {"シャ","sha"},{"シュ","shu"},{"ショ","sho"},
-                                       {"ジャ","ja"},{"ジュ","ju"},{"ジョ","jo"},
-                                       {"チャ","cha"},{"チュ","chu"},{"チョ","cho"},
-                                       {"ヂャ","ja(chi)"},{"ヂュ","ju(chi)"},{"ヂョ","jo(chi)"},
-                                       {"ニャ","nya"},{"ニュ","nyu"},{"ニョ","nyo"},
-                                       {"ヒャ","hya"},{"ヒュ","hyu"},{"ヒョ","hyo"},
-                                       {"ミャ","mya"},{"ミュ","myu"},{"ミョ","myo"},
-                                       {"リャ","rya"},{"リュ","ryu"},{"リョ","ryo"},
-                                       };
-
-    return R.value(k, "");
-}
-// Load mastered only
-void PracticeSessionPage::loadMasteredFromStats()
-{
-    m_masteredRomaji.clear();
-
-    QFile f("data/user_stats.json");
-    if (!f.open(QIODevice::ReadOnly))
-        return;
-
-    auto doc = QJsonDocument::fromJson(f.readAll());
-    f.close();
-
-    auto obj = doc.object();
-
-    auto readBlock = [&](const QJsonObject &o) {
-        for (auto v : o["mastered"].toArray())
-            m_masteredRomaji.insert(v.toString());
-    };
-
-    readBlock(obj["hiragana"].toObject());
-    readBlock(obj["katakana"].toObject());
-}
-
 // Ask question
 void PracticeSessionPage::askQuestion()
 {
-    if (m_config.questionLimit != -1 &&
+    KANA_TRACE_SCOPE("PracticeSessionPage::askQuestion");
+
+    if (!m_config.isDrill() && m_config.questionLimit != -1 &&
         m_questionIndex >= m_config.questionLimit)
     {
         finishSession();
         return;
     }
 
-    // reset UI
-    for (auto &b : opt)
+    if (!m_prepared.ready)
+        m_engine.prepare(m_prepared);
+
+    // reset UI; style sheets are only reapplied where an answer changed them
+    for (int i = 0; i < 4; ++i)
     {
-        b->setEnabled(true);
-        b->setStyleSheet(optionStyleNormal());
+        opt[i]->setEnabled(true);
+        if (m_styledOptions & (1 << i))
+            opt[i]->setStyleSheet(optionStyleNormal());
     }
+    m_styledOptions = 0;
 
     btnNext->setEnabled(false);
     lblFeedback->clear();
 
-    m_current = m_pool[
-        QRandomGenerator::global()->bounded(m_pool.size())
-    ];
-
-    if (m_config.mode == PracticeConfig::Mode::KanaToRomaji)
-        m_showKana = true;
-    else if (m_config.mode == PracticeConfig::Mode::RomajiToKana)
-        m_showKana = false;
-    else
-        m_showKana = QRandomGenerator::global()->bounded(2);
-
-    lblQuestion->setText(m_showKana ? m_current.kana : m_current.romaji);
-    lblSubtitle->setText(m_showKana ? "Kana → Romaji" : "Romaji → Kana");
-
-    QString correctText = m_showKana ? m_current.romaji : m_current.kana;
-
-    m_correctIndex = QRandomGenerator::global()->bounded(4);
-
-    QSet<QString> usedKana;
-    QSet<QString> usedRomaji;
-
-    usedKana.insert(m_current.kana);
-    usedRomaji.insert(m_current.romaji);
-
-    opt[m_correctIndex]->setText(correctText);
-
-    auto pickDistractor = [&](const QVector<QuizKanaItem> &source,
-                              QuizKanaItem &out) -> bool
-    {
-        for (int i = 0; i < 100; ++i)
-        {
-            const auto &it = source[
-                QRandomGenerator::global()->bounded(source.size())
-            ];
-
-            if (it.kana == m_current.kana)
-                continue;
-
-            if (!m_showKana && it.isHiragana != m_current.isHiragana)
-                continue;
-
-            if (usedKana.contains(it.kana))
-                continue;
-
-            if (usedRomaji.contains(it.romaji))
-                continue;
-
-            out = it;
-            return true;
-        }
-        return false;
-    };
+    m_current = m_prepared.item;
+    m_engine.setCurrent(m_current);
+    m_showKana = m_prepared.showKana;
+    m_correctIndex = m_prepared.correctIndex;
+    m_prepared.ready = false;
 
     for (int i = 0; i < 4; ++i)
     {
-        if (i == m_correctIndex)
-            continue;
-
-        QuizKanaItem candidate;
-        bool found = false;
-
-        found = pickDistractor(m_pool, candidate);
+        m_optionIds[i] = m_prepared.optionIds[i];
+        opt[i]->setText(m_prepared.optionText[i]);
+    }
 
-        if (!found)
-            found = pickDistractor(m_all, candidate);
+    // The item after this one is chosen now so its clip can be
+    // decoded while this question is being answered
+    m_next = m_engine.lookAhead();
 
-        if (!found)
-        {
-            opt[i]->setText("—");
-            continue;
-        }
+    const bool listening = m_config.mode == PracticeConfig::Mode::AudioToKana;
 
-        usedKana.insert(candidate.kana);
-        usedRomaji.insert(candidate.romaji);
+    if (listening)
+    {
+        lblQuestion->setText("🔊");
+        lblSubtitle->setText("Listen → Kana");
 
-        opt[i]->setText(
-            m_showKana ? candidate.romaji : candidate.kana
-            );
+        AudioService *audio = AudioService::instance();
+        audio->play(m_current.id);
+        audio->preload(m_next.id);
     }
+    else
+    {
+        lblQuestion->setText(m_showKana ? m_current.kana : m_current.romaji);
+        lblSubtitle->setText(m_showKana ? "Kana → Romaji" : "Romaji → Kana");
+    }
+    btnReplay->setVisible(listening);
+
     m_active = true;
     m_questionIndex++;
+    m_answerTimer.start();
 
-    if (m_config.questionLimit == -1)
+    // A key pressed during the transition answers this question
+    if (m_bufferedAnswer >= 0)
+    {
+        const int index = std::exchange(m_bufferedAnswer, -1);
+        QMetaObject::invokeMethod(this, [this, index, n = m_questionIndex]() {
+            if (m_questionIndex == n)
+                answer(index);
+        }, Qt::QueuedConnection);
+    }
+
+    if (m_config.isDrill())
+        updateDrillClock();
+    else if (m_config.questionLimit == -1)
         lblCounter->setText(QString::number(m_questionIndex));
     else
         lblCounter->setText(
@@ -572,61 +406,164 @@ void PracticeSessionPage::askQuestion()
 // Answer
 void PracticeSessionPage::answer(int index)
 {
+    KANA_TRACE_SCOPE("PracticeSessionPage::answer");
+
     if (!m_active)
         return;
 
     m_active = false;
+    m_answered++;
 
     bool correctAns = (index == m_correctIndex);
 
-    for (auto &b : opt)
-        b->setEnabled(false);
+    // Drill: a correct answer goes straight to the next question, so no feedback
+    const bool moveOn = correctAns && m_config.isDrill();
+
+    if (!moveOn)
+        for (auto &b : opt)
+            b->setEnabled(false);
 
     if (correctAns)
     {
-        opt[index]->setStyleSheet(optionStyleCorrect());
-        lblFeedback->setText("Correct!");
+        if (!moveOn)
+        {
+            opt[index]->setStyleSheet(optionStyleCorrect());
+            m_styledOptions |= 1 << index;
+            lblFeedback->setText("Correct!");
+        }
         m_correctCount++;
-
-        progress->addCorrect(m_current.isHiragana);
-        progress->addAnswered(true);
-
-        progress->addSymbolAnswer(
-            m_current.isHiragana,
-            m_current.romaji,
-            true
-            );
     }
     else
     {
         opt[index]->setStyleSheet(optionStyleWrong());
         opt[m_correctIndex]->setStyleSheet(optionStyleCorrect());
+        m_styledOptions |= (1 << index) | (1 << m_correctIndex);
 
-        lblFeedback->setText("Wrong. Correct: " + opt[m_correctIndex]->text());
-        progress->addWrong(m_current.isHiragana);
-        progress->addAnswered(false);
+        lblFeedback->setText("Wrong. Correct: " + opt[m_correctIndex]->text() +
+                             (m_config.mode == PracticeConfig::Mode::AudioToKana
+                                  ? " (" + KanaCatalog::displayRomaji(m_current.id) + ")"
+                                  : QString()));
+    }
 
-        progress->addSymbolAnswer(
-            m_current.isHiragana,
-            m_current.romaji,
-            false
-            );
+    AnswerHistory::Direction direction = AnswerHistory::Direction::KanaToRomaji;
+    if (m_config.mode == PracticeConfig::Mode::AudioToKana)
+        direction = AnswerHistory::Direction::AudioToKana;
+    else if (!m_showKana)
+        direction = AnswerHistory::Direction::RomajiToKana;
+
+    progress->recordAnswer(
+        m_current.isHiragana,
+        m_current.id,
+        correctAns,
+        m_optionIds[index],
+        direction,
+        int(qMin<qint64>((m_answerTimer.nsecsElapsed() + 500000) / 1000000,
+                         LatencyHistogram::MaxMs))
+        );
+
+    m_engine.answered(m_current, progress);
+
+    if (moveOn)
+    {
+        askQuestion();
+        return;
+    }
+
+    if (m_config.isDrill())
+        advanceTimer->start(DRILL_WRONG_PAUSE_MS);
+    else
+        btnNext->setEnabled(true);
+
+    // Build the next question once the feedback has been painted,
+    // well before the fade-out ends
+    const bool more = m_config.isDrill() || m_config.questionLimit == -1 ||
+                      m_questionIndex < m_config.questionLimit;
+    if (more)
+    {
+        QMetaObject::invokeMethod(this, [this]() {
+            if (!m_prepared.ready && m_engine.hasLookAhead())
+                m_engine.prepare(m_prepared);
+        }, Qt::QueuedConnection);
     }
-    btnNext->setEnabled(true);
 }
 
 
 // Next
 void PracticeSessionPage::nextQuestion()
 {
+    if (fadeOut->state() == QAbstractAnimation::Running)
+        return;
+
     fadeOut->start();
 }
 
+bool PracticeSessionPage::inTransition() const
+{
+    return fadeOut->state() == QAbstractAnimation::Running || advanceTimer->isActive();
+}
+
+
+// Keyboard
+void PracticeSessionPage::keyPressEvent(QKeyEvent *event)
+{
+    const int key = event->key();
+
+    if (key >= Qt::Key_1 && key <= Qt::Key_4)
+    {
+        if (event->isAutoRepeat())
+            return;
+
+        const int index = key - Qt::Key_1;
+        if (m_active && opt[index]->isVisible())
+            answer(index);
+        else if (inTransition())
+            m_bufferedAnswer = index;
+        return;
+    }
+
+    if ((key == Qt::Key_Return || key == Qt::Key_Enter) &&
+        btnNext->isVisible() && btnNext->isEnabled())
+    {
+        nextQuestion();
+        return;
+    }
+
+    QWidget::keyPressEvent(event);
+}
+
+
+// Speed drill countdown
+void PracticeSessionPage::updateDrillClock()
+{
+    const qint64 left = qint64(m_config.timeBudgetSecs) * 1000 - m_drillClock.elapsed();
+    if (left <= 0)
+    {
+        finishSession();
+        return;
+    }
+
+    const QString text = QString("%1 answered · %2 s")
+                             .arg(m_answered)
+                             .arg((left + 999) / 1000);
+    if (lblCounter->text() != text)
+        lblCounter->setText(text);
+}
+
 
 // Finish
 void PracticeSessionPage::finishSession()
 {
+    m_active = false;
+    m_bufferedAnswer = -1;
+    advanceTimer->stop();
+    drillTick->stop();
+
+    // Fold the answer journal into user_stats.json
+    progress->save();
+    AudioService::instance()->stop();
+
     btnHome->hide();
+    btnReplay->hide();
     lblFeedback->hide();
     btnStop->hide();
 
@@ -637,11 +574,28 @@ void PracticeSessionPage::finishSession()
     lblQuestion->hide();
     lblSubtitle->hide();
 
-    lblResult->setText(
-        QString("🎉 Session finished 🎉\n\nCorrect: %1\nTotal: %2")
-            .arg(m_correctCount)
-            .arg(m_questionIndex)
-        );
+    if (m_config.isDrill())
+    {
+        // Stopped early: the rate is over the time actually spent
+        const double minutes = qMax<qint64>(1000, m_drillClock.elapsed()) / 60000.0;
+
+        lblResult->setText(
+            QString("⏱ Drill finished ⏱\n\nCorrect: %1\nAnswered: %2\n"
+                    "%3 questions / min (%4 correct / min)")
+                .arg(m_correctCount)
+                .arg(m_answered)
+                .arg(m_answered / minutes, 0, 'f', 1)
+                .arg(m_correctCount / minutes, 0, 'f', 1)
+            );
+    }
+    else
+    {
+        lblResult->setText(
+            QString("🎉 Session finished 🎉\n\nCorrect: %1\nTotal: %2")
+                .arg(m_correctCount)
+                .arg(m_questionIndex)
+            );
+    }
 
     resultWidget->show();
 }
@@ -653,5 +607,12 @@ void PracticeSessionPage::stopSession()
 
 void PracticeSessionPage::exitSession()
 {
+    m_active = false;
+    m_bufferedAnswer = -1;
+    advanceTimer->stop();
+    drillTick->stop();
+
+    progress->save();
+    AudioService::instance()->stop();
     emit backToSetup();
 }
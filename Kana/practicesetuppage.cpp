@@ -61,9 +61,9 @@ void PracticeSetupPage::buildUi()
     root->addWidget(modeLabel);
 
     auto *modeRow = new QHBoxLayout();
-    QStringList modes = { "Kana → Romaji", "Romaji → Kana", "Mixed" };
+    QStringList modes = { "Kana → Romaji", "Romaji → Kana", "Mixed", "Listening" };
 
-    for (int i = 0; i < 3; ++i) {
+    for (int i = 0; i < 4; ++i) {
         btnMode[i] = new QPushButton(modes[i]);
         modeRow->addWidget(btnMode[i]);
 
@@ -102,9 +102,13 @@ void PracticeSetupPage::buildUi()
 
     btnSourceAll = new QPushButton("All");
     btnSourceMastered = new QPushButton("Mastered");
+    btnSourceDue = new QPushButton("Due for review");
+    btnSourceConfused = new QPushButton("Confused pairs");
 
     sourceRow->addWidget(btnSourceAll);
     sourceRow->addWidget(btnSourceMastered);
+    sourceRow->addWidget(btnSourceDue);
+    sourceRow->addWidget(btnSourceConfused);
     root->addLayout(sourceRow);
 
     connect(btnSourceAll, &QPushButton::clicked, this, [this]() {
@@ -117,6 +121,40 @@ void PracticeSetupPage::buildUi()
         updateButtonStates();
     });
 
+    connect(btnSourceDue, &QPushButton::clicked, this, [this]() {
+        m_config.source = PracticeConfig::Source::Due;
+        updateButtonStates();
+    });
+
+    connect(btnSourceConfused, &QPushButton::clicked, this, [this]() {
+        m_config.source = PracticeConfig::Source::Confused;
+        updateButtonStates();
+    });
+
+    // Distractors
+    auto *optionsLabel = new QLabel("Wrong options");
+    optionsLabel->setStyleSheet("color:#aaa;");
+    root->addWidget(optionsLabel);
+
+    auto *optionsRow = new QHBoxLayout();
+
+    btnOptionsRandom = new QPushButton("Random");
+    btnOptionsLookAlike = new QPushButton("Look-alike");
+
+    optionsRow->addWidget(btnOptionsRandom);
+    optionsRow->addWidget(btnOptionsLookAlike);
+    root->addLayout(optionsRow);
+
+    connect(btnOptionsRandom, &QPushButton::clicked, this, [this]() {
+        m_config.distractors = PracticeConfig::Distractors::Random;
+        updateButtonStates();
+    });
+
+    connect(btnOptionsLookAlike, &QPushButton::clicked, this, [this]() {
+        m_config.distractors = PracticeConfig::Distractors::LookAlike;
+        updateButtonStates();
+    });
+
     // Question count
     auto *countLabel = new QLabel("Questions");
     countLabel->setStyleSheet("color:#aaa;");
@@ -137,6 +175,26 @@ void PracticeSetupPage::buildUi()
     }
     root->addLayout(countRow);
 
+    // Speed drill
+    auto *drillLabel = new QLabel("Speed drill");
+    drillLabel->setStyleSheet("color:#aaa;");
+    root->addWidget(drillLabel);
+
+    auto *drillRow = new QHBoxLayout();
+    QList<int> budgets = { 0, 30, 60, 120 };
+    QStringList budgetLabels = { "Off", "30 s", "60 s", "120 s" };
+
+    for (int i = 0; i < 4; ++i) {
+        btnDrill[i] = new QPushButton(budgetLabels[i]);
+        drillRow->addWidget(btnDrill[i]);
+
+        connect(btnDrill[i], &QPushButton::clicked, this, [=]() {
+            m_config.timeBudgetSecs = budgets[i];
+            updateButtonStates();
+        });
+    }
+    root->addLayout(drillRow);
+
     // Start
     btnStart = new QPushButton("Start Practice");
     btnStart->setStyleSheet(
@@ -157,7 +215,7 @@ void PracticeSetupPage::buildUi()
 
 void PracticeSetupPage::updateButtonStates()
 {
-    for (int i = 0; i < 3; ++i)
+    for (int i = 0; i < 4; ++i)
         btnMode[i]->setStyleSheet(toggleStyle(i == (int)m_config.mode));
 
     for (int i = 0; i < 3; ++i)
@@ -168,10 +226,30 @@ void PracticeSetupPage::updateButtonStates()
         btnCount[i]->setStyleSheet(
             toggleStyle(m_config.questionLimit == counts[i])
             );
+
+    // The drill runs until the time is up, whatever the question count
+    QList<int> budgets = { 0, 30, 60, 120 };
+    for (int i = 0; i < 4; ++i)
+    {
+        btnDrill[i]->setStyleSheet(toggleStyle(m_config.timeBudgetSecs == budgets[i]));
+        btnCount[i]->setEnabled(!m_config.isDrill());
+    }
     btnSourceAll->setStyleSheet(
         toggleStyle(m_config.source == PracticeConfig::Source::All));
 
     btnSourceMastered->setStyleSheet(
         toggleStyle(m_config.source == PracticeConfig::Source::Mastered));
+
+    btnSourceDue->setStyleSheet(
+        toggleStyle(m_config.source == PracticeConfig::Source::Due));
+
+    btnSourceConfused->setStyleSheet(
+        toggleStyle(m_config.source == PracticeConfig::Source::Confused));
+
+    btnOptionsRandom->setStyleSheet(
+        toggleStyle(m_config.distractors == PracticeConfig::Distractors::Random));
+
+    btnOptionsLookAlike->setStyleSheet(
+        toggleStyle(m_config.distractors == PracticeConfig::Distractors::LookAlike));
 }
 
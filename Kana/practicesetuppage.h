@@ -25,11 +25,16 @@ private:
     PracticeConfig m_config;
 
     // Buttons
-    QPushButton *btnMode[3];
+    QPushButton *btnMode[4];
     QPushButton *btnScript[3];
     QPushButton *btnSourceAll;
     QPushButton *btnSourceMastered;
+    QPushButton *btnSourceDue;
+    QPushButton *btnSourceConfused;
+    QPushButton *btnOptionsRandom;
+    QPushButton *btnOptionsLookAlike;
     QPushButton *btnCount[4];
+    QPushButton *btnDrill[4];
     QPushButton *btnStart;
     QPushButton *btnHome;
 };
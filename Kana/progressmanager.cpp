@@ -1,209 +1,630 @@
 #include "progressmanager.h"
-#include <QFile>
+#include "progressstore.h"
+#include "kanacatalog.h"
+#include "trace.h"
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QDateTime>
+#include <QThread>
+#include <QTimer>
 #include <QDebug>
 
+#include <algorithm>
+
+// Journal is folded into the snapshot at most this often
+static const int COMPACT_INTERVAL_MS = 30000;
+
+static const int MASTER_THRESHOLD = 3;
+
 ProgressManager::ProgressManager(QObject *parent)
+    : ProgressManager(defaultPath(), parent)
+{
+}
+
+ProgressManager::ProgressManager(const QString &path, QObject *parent)
     : QObject(parent)
+    , filePath(path)
 {
-    filePath = "data/user_stats.json";
+
+    ioThread = new QThread(this);
+    store = new ProgressStore(filePath);
+    store->moveToThread(ioThread);
+    connect(ioThread, &QThread::finished, store, &QObject::deleteLater);
+
+    compactTimer = new QTimer(this);
+    compactTimer->setSingleShot(true);
+    compactTimer->setInterval(COMPACT_INTERVAL_MS);
+    connect(compactTimer, &QTimer::timeout, this, &ProgressManager::save);
+
     load();
+    ioThread->start();
 }
 
-// JSON creating
-void ProgressManager::ensureDefaults()
+ProgressManager::~ProgressManager()
 {
-    if (!data.contains("practice"))
+    // Shutdown: fold the journal into the snapshot before the thread stops
+    flushHistory();
+
+    if (dirty)
     {
-        QJsonObject o;
-        o["totalAnswered"] = 0;
-        o["totalCorrect"]  = 0;
-        data["practice"] = o;
+        const QJsonObject snapshot = toJson();
+        ProgressStore *s = store;
+        QMetaObject::invokeMethod(store, [s, snapshot]() {
+            s->compact(snapshot);
+        }, Qt::BlockingQueuedConnection);
     }
 
-    if (!data.contains("hiragana"))
+    ioThread->quit();
+    ioThread->wait();
+}
+
+void ProgressManager::reset()
+{
+    totalAnswered = 0;
+    totalCorrect  = 0;
+
+    for (ScriptStats *s : { &hiragana, &katakana })
     {
-        QJsonObject o;
-        o["correct"]  = 0;
-        o["wrong"]    = 0;
-        o["streak"]   = 0;
-        if (!o.contains("symbolStreak"))
-            o["symbolStreak"] = QJsonObject();
-        o["mastered"] = QJsonArray();
-        data["hiragana"] = o;
+        s->correct = 0;
+        s->wrong   = 0;
+        s->streak  = 0;
+        s->symbols.fill(SymbolStats(), KanaCatalog::Count);
+        s->latency.clear();
+        s->confusion.clear();
     }
+}
 
-    if (!data.contains("katakana"))
-    {
+
+// JSON boundary
+QJsonObject ProgressManager::toJson() const
+{
+    QJsonObject root;
+
+    QJsonObject pr;
+    pr["totalAnswered"] = totalAnswered;
+    pr["totalCorrect"]  = totalCorrect;
+    root["practice"] = pr;
+
+    auto writeScript = [](const ScriptStats &s) {
         QJsonObject o;
-        o["correct"]  = 0;
-        o["wrong"]    = 0;
-        o["streak"]   = 0;
-        if (!o.contains("symbolStreak"))
-            o["symbolStreak"] = QJsonObject();
-        o["mastered"] = QJsonArray();
-        data["katakana"] = o;
-    }
+        o["correct"] = s.correct;
+        o["wrong"]   = s.wrong;
+        o["streak"]  = s.streak;
+
+        QJsonArray  mastered;
+        QJsonObject symbolStreak;
+        QJsonObject symbolCorrect;
+        QJsonObject symbolWrong;
+        QJsonObject schedule;
+        QJsonObject latency;
+
+        for (int id = 0; id < KanaCatalog::Count; ++id)
+        {
+            const SymbolStats &st = s.symbols[id];
+            const QString romaji = KanaCatalog::romaji(id);
+
+            if (st.mastered)
+                mastered.append(romaji);
+            if (st.streak)
+                symbolStreak[romaji] = st.streak;
+            if (st.correct)
+                symbolCorrect[romaji] = qint64(st.correct);
+            if (st.wrong)
+                symbolWrong[romaji] = qint64(st.wrong);
+            if (!st.review.isNew())
+            {
+                QJsonObject r;
+                r["due"]  = st.review.due;
+                r["ivl"]  = st.review.interval;
+                r["ease"] = double(st.review.ease);
+                r["reps"] = st.review.reps;
+                schedule[romaji] = r;
+            }
+
+            // {"romaji": [per direction histogram, ...]}
+            bool timed = false;
+            QJsonArray perDirection;
+            for (const LatencyHistogram &h : st.latency)
+            {
+                timed = timed || !h.isEmpty();
+                perDirection.append(h.toJson());
+            }
+            if (timed)
+                latency[romaji] = perDirection;
+        }
+
+        o["mastered"]      = mastered;
+        o["symbolStreak"]  = symbolStreak;
+        o["symbolCorrect"] = symbolCorrect;
+        o["symbolWrong"]   = symbolWrong;
+        o["schedule"]      = schedule;
+        o["latency"]       = latency;
+
+        // {"shown": {"chosen": count}}
+        QJsonObject confusion;
+        for (auto it = s.confusion.cbegin(); it != s.confusion.cend(); ++it)
+        {
+            const QString shown  = KanaCatalog::romaji(int(it.key() >> 16));
+            const QString chosen = KanaCatalog::romaji(int(it.key() & 0xFFFF));
+
+            QJsonObject row = confusion[shown].toObject();
+            row[chosen] = qint64(it.value());
+            confusion[shown] = row;
+        }
+        o["confusion"] = confusion;
+        return o;
+    };
+
+    root["hiragana"] = writeScript(hiragana);
+    root["katakana"] = writeScript(katakana);
+    root["journalSeq"] = journalSeq;
+    return root;
+}
+
+void ProgressManager::fromJson(const QJsonObject &root)
+{
+    reset();
+
+    const QJsonObject pr = root["practice"].toObject();
+    totalAnswered = pr["totalAnswered"].toInt();
+    totalCorrect  = pr["totalCorrect"].toInt();
+
+    auto readScript = [](const QJsonObject &o, ScriptStats &s) {
+        s.correct = o["correct"].toInt();
+        s.wrong   = o["wrong"].toInt();
+        s.streak  = o["streak"].toInt();
+
+        for (const auto &v : o["mastered"].toArray())
+        {
+            const int id = KanaCatalog::idOfRomaji(v.toString());
+            if (id >= 0)
+                s.symbols[id].mastered = true;
+        }
+
+        auto readCounters = [&s](const QJsonObject &map, auto field) {
+            for (auto it = map.begin(); it != map.end(); ++it)
+            {
+                const int id = KanaCatalog::idOfRomaji(it.key());
+                if (id >= 0)
+                    s.symbols[id].*field = it.value().toInt();
+            }
+        };
+
+        readCounters(o["symbolStreak"].toObject(),  &SymbolStats::streak);
+        readCounters(o["symbolCorrect"].toObject(), &SymbolStats::correct);
+        readCounters(o["symbolWrong"].toObject(),   &SymbolStats::wrong);
+
+        const QJsonObject schedule = o["schedule"].toObject();
+        for (auto it = schedule.begin(); it != schedule.end(); ++it)
+        {
+            const int id = KanaCatalog::idOfRomaji(it.key());
+            if (id < 0)
+                continue;
+
+            const QJsonObject r = it.value().toObject();
+            ReviewState &rv = s.symbols[id].review;
+            rv.due      = r["due"].toInteger();
+            rv.interval = r["ivl"].toInt();
+            rv.ease     = float(r["ease"].toDouble(2.5));
+            rv.reps     = r["reps"].toInt();
+        }
+
+        const QJsonObject latency = o["latency"].toObject();
+        for (auto it = latency.begin(); it != latency.end(); ++it)
+        {
+            const int id = KanaCatalog::idOfRomaji(it.key());
+            if (id < 0)
+                continue;
+
+            const QJsonArray perDirection = it.value().toArray();
+            SymbolStats &st = s.symbols[id];
+            for (int d = 0; d < DirectionCount && d < perDirection.size(); ++d)
+            {
+                st.latency[d] = LatencyHistogram::fromJson(perDirection[d].toArray());
+                s.latency.merge(st.latency[d]);
+            }
+        }
+
+        const QJsonObject confusion = o["confusion"].toObject();
+        for (auto it = confusion.begin(); it != confusion.end(); ++it)
+        {
+            const int shown = KanaCatalog::idOfRomaji(it.key());
+            if (shown < 0)
+                continue;
+
+            const QJsonObject row = it.value().toObject();
+            for (auto c = row.begin(); c != row.end(); ++c)
+            {
+                const int chosen = KanaCatalog::idOfRomaji(c.key());
+                const int count  = c.value().toInt();
+                if (chosen >= 0 && chosen != shown && count > 0)
+                    s.confusion[confusionKey(shown, chosen)] = quint32(count);
+            }
+        }
+    };
+
+    readScript(root["hiragana"].toObject(), hiragana);
+    readScript(root["katakana"].toObject(), katakana);
+
+    journalSeq = root["journalSeq"].toInteger();
 }
 
 
 //  Load JSON
 void ProgressManager::load()
 {
-    QFile f(filePath);
-    if (!f.open(QIODevice::ReadOnly))
+    KANA_TRACE_SCOPE("ProgressManager::load");
+
+    // History first, so the journal replay knows which answers it already has
+    const QByteArray historyBytes = ProgressStore::readHistory(filePath);
+    const int valid = history.load(historyBytes);
+    if (valid < historyBytes.size())
+        ProgressStore::truncateHistory(filePath, valid);
+
+    if (!ProgressStore::snapshotExists(filePath))
     {
         qDebug() << "Stats file not found. Creating new.";
-        data = QJsonObject();
-        ensureDefaults();
+        reset();
+        journalSeq = 0;
+        replayJournal(0);
         save();
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(f.readAll());
-    data = doc.object();
-    f.close();
+    fromJson(ProgressStore::readSnapshot(filePath));
+    replayJournal(journalSeq);
+}
 
-    ensureDefaults();
+// Answers recorded after the last compaction
+void ProgressManager::replayJournal(qint64 snapshotSeq)
+{
+    for (const QJsonObject &r : ProgressStore::readJournal(filePath))
+    {
+        const qint64 n = r["n"].toInteger();
+        if (n <= snapshotSeq)
+            continue;
+
+        const int id = KanaCatalog::idOfRomaji(r["r"].toString());
+        const int chosenId = r.contains("x") ? KanaCatalog::idOfRomaji(r["x"].toString()) : -1;
+        const qint64 when = r.contains("t") ? r["t"].toInteger()
+                                            : QDateTime::currentSecsSinceEpoch();
+        const int d = r["d"].toInt();
+        const auto direction = d >= 0 && d < DirectionCount ? AnswerHistory::Direction(d)
+                                                            : AnswerHistory::Direction::KanaToRomaji;
+        const int responseMs = r.contains("ms") ? r["ms"].toInt() : -1;
+        if (id >= 0)
+        {
+            const bool isHiragana = r["k"].toString() == "h";
+            const bool correct = r["c"].toInt() != 0;
+            applyAnswer(isHiragana, id, correct, chosenId, when, direction, responseMs);
+
+            if (n > history.lastSeq())
+                history.append(when, isHiragana, id, correct, chosenId,
+                               direction, responseMs, n);
+        }
+        journalSeq = qMax(journalSeq, n);
+    }
 }
 
 
-// Save JSON
+// Save JSON (asynchronous, on the io thread)
 void ProgressManager::save()
 {
-    QFile f(filePath);
-    if (!f.open(QIODevice::WriteOnly))
-    {
-        qDebug() << "Cannot write stats file!";
+    KANA_TRACE_SCOPE("ProgressManager::save");
+
+    compactTimer->stop();
+    dirty = false;
+
+    // Before the compaction, which drops the journal records it came from
+    flushHistory();
+
+    const QJsonObject snapshot = toJson();
+    ProgressStore *s = store;
+    QMetaObject::invokeMethod(store, [s, snapshot]() {
+        s->compact(snapshot);
+    });
+}
+
+void ProgressManager::flushHistory()
+{
+    if (!history.hasUnflushed())
         return;
+
+    const QByteArray block = history.takeUnflushed();
+    ProgressStore *s = store;
+    QMetaObject::invokeMethod(store, [s, block]() {
+        s->appendHistory(block);
+    });
+}
+
+void ProgressManager::markDirty()
+{
+    dirty = true;
+    if (!compactTimer->isActive())
+        compactTimer->start();
+}
+
+
+// Answer journal
+void ProgressManager::recordAnswer(bool isHiragana, int id, bool correct, int chosenId,
+                                   AnswerHistory::Direction direction, int responseMs)
+{
+    KANA_TRACE_SCOPE("ProgressManager::recordAnswer");
+
+    if (!KanaCatalog::isValid(id))
+        return;
+
+    if (correct || !KanaCatalog::isValid(chosenId) || chosenId == id)
+        chosenId = -1;
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    applyAnswer(isHiragana, id, correct, chosenId, now, direction, responseMs);
+    history.append(now, isHiragana, id, correct, chosenId, direction, responseMs,
+                   journalSeq + 1);
+
+    // Journal keys symbols by romaji so it survives catalog changes
+    QJsonObject r;
+    r["n"] = ++journalSeq;
+    r["t"] = now;
+    r["k"] = isHiragana ? "h" : "k";
+    r["r"] = KanaCatalog::romaji(id);
+    r["c"] = correct ? 1 : 0;
+    if (chosenId >= 0)
+        r["x"] = KanaCatalog::romaji(chosenId);
+    r["d"] = int(direction);
+    if (responseMs >= 0)
+        r["ms"] = responseMs;
+
+    const QByteArray line = QJsonDocument(r).toJson(QJsonDocument::Compact);
+    ProgressStore *s = store;
+    QMetaObject::invokeMethod(store, [s, line]() {
+        s->append(line);
+    });
+}
+
+void ProgressManager::applyAnswer(bool isHiragana, int id, bool correct, int chosenId,
+                                  qint64 when, AnswerHistory::Direction direction,
+                                  int responseMs)
+{
+    if (correct)
+        addCorrect(isHiragana);
+    else
+        addWrong(isHiragana);
+
+    addAnswered(correct);
+    addSymbolAnswer(isHiragana, id, correct);
+
+    ReviewState &rv = script(isHiragana).symbols[id].review;
+    rv = SrsScheduler::grade(rv, correct, when);
+
+    if (!correct && chosenId >= 0)
+        script(isHiragana).confusion[confusionKey(id, chosenId)]++;
+
+    if (responseMs >= 0)
+    {
+        script(isHiragana).symbols[id].latency[int(direction)].record(responseMs);
+        script(isHiragana).latency.record(responseMs);
     }
 
-    QJsonDocument doc(data);
-    f.write(doc.toJson(QJsonDocument::Indented));
-    f.close();
+    emit symbolChanged(isHiragana, id);
+    emit totalsChanged();
 }
 
 
 // Practice
 int ProgressManager::getTotalAnswered() const
 {
-    return data["practice"].toObject()["totalAnswered"].toInt();
+    return totalAnswered;
 }
 
 int ProgressManager::getTotalCorrect() const
 {
-    return data["practice"].toObject()["totalCorrect"].toInt();
+    return totalCorrect;
 }
 
 void ProgressManager::addAnswered(bool correct)
 {
-    QJsonObject o = data["practice"].toObject();
-    o["totalAnswered"] = o["totalAnswered"].toInt() + 1;
+    totalAnswered++;
     if (correct)
-        o["totalCorrect"] = o["totalCorrect"].toInt() + 1;
-    data["practice"] = o;
-    save();
+        totalCorrect++;
+    markDirty();
 }
 
 
 //  Kana counters
 void ProgressManager::addCorrect(bool isHiragana)
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
-
-    QJsonObject o = data[key].toObject();
-    o["correct"] = o["correct"].toInt() + 1;
-    o["streak"]  = o["streak"].toInt() + 1;
-    data[key] = o;
-    save();
+    ScriptStats &s = script(isHiragana);
+    s.correct++;
+    s.streak++;
+    markDirty();
 }
 
 void ProgressManager::addWrong(bool isHiragana)
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
-
-    QJsonObject o = data[key].toObject();
-    o["wrong"]  = o["wrong"].toInt() + 1;
-    o["streak"] = 0;
-    data[key] = o;
-    save();
+    ScriptStats &s = script(isHiragana);
+    s.wrong++;
+    s.streak = 0;
+    markDirty();
 }
 
 int ProgressManager::getCorrect(bool isHiragana) const
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
-    return data[key].toObject()["correct"].toInt();
+    return script(isHiragana).correct;
 }
 
 int ProgressManager::getWrong(bool isHiragana) const
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
-    return data[key].toObject()["wrong"].toInt();
+    return script(isHiragana).wrong;
 }
 
 int ProgressManager::getStreak(bool isHiragana) const
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
-    return data[key].toObject()["streak"].toInt();
+    return script(isHiragana).streak;
 }
 
 
 //  Mastery
-void ProgressManager::markMastered(bool isHiragana, const QString &romaji)
+QStringList ProgressManager::getMastered(bool isHiragana) const
+{
+    QStringList list;
+
+    const ScriptStats &s = script(isHiragana);
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+        if (s.symbols[id].mastered)
+            list.append(KanaCatalog::romaji(id));
+    return list;
+}
+
+bool ProgressManager::isMastered(bool isHiragana, const QString &romaji) const
+{
+    const SymbolStats *st = symbol(isHiragana, romaji);
+    return st && st->mastered;
+}
+
+bool ProgressManager::isMastered(bool isHiragana, int id) const
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
+    return KanaCatalog::isValid(id) && script(isHiragana).symbols[id].mastered;
+}
 
-    QJsonObject o = data[key].toObject();
-    QJsonArray arr = o["mastered"].toArray();
+void ProgressManager::addSymbolAnswer(bool isHiragana, int id, bool correct)
+{
+    SymbolStats &st = script(isHiragana).symbols[id];
 
-    if (!arr.contains(romaji))
+    if (correct)
     {
-        arr.append(romaji);
-        o["mastered"] = arr;
-        data[key] = o;
-        save();
+        st.correct++;
+        st.streak++;
     }
+    else
+    {
+        st.wrong++;
+        st.streak = 0;
+    }
+
+    if (st.streak >= MASTER_THRESHOLD)
+        st.mastered = true;
+
+    markDirty();
 }
 
-QStringList ProgressManager::getMastered(bool isHiragana) const
+
+// Per-symbol stats
+const ProgressManager::SymbolStats *ProgressManager::symbol(bool isHiragana, const QString &romaji) const
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
-    QStringList list;
+    const int id = KanaCatalog::idOfRomaji(romaji);
+    return id >= 0 ? &script(isHiragana).symbols[id] : nullptr;
+}
 
-    QJsonArray arr = data[key].toObject()["mastered"].toArray();
-    for (const auto &v : arr)
-        list.append(v.toString());
-    return list;
+int ProgressManager::getSymbolCorrect(bool isHiragana, const QString &romaji) const
+{
+    const SymbolStats *st = symbol(isHiragana, romaji);
+    return st ? int(st->correct) : 0;
 }
 
-void ProgressManager::addSymbolAnswer(bool isHiragana, const QString &romaji, bool correct)
+int ProgressManager::getSymbolWrong(bool isHiragana, const QString &romaji) const
 {
-    QString key = isHiragana ? "hiragana" : "katakana";
-    QJsonObject block = data[key].toObject();
+    const SymbolStats *st = symbol(isHiragana, romaji);
+    return st ? int(st->wrong) : 0;
+}
 
-    QJsonObject symbolStreak = block["symbolStreak"].toObject();
-    int streak = symbolStreak.value(romaji).toInt();
+int ProgressManager::getSymbolStreak(bool isHiragana, const QString &romaji) const
+{
+    const SymbolStats *st = symbol(isHiragana, romaji);
+    return st ? st->streak : 0;
+}
 
-    if (correct)
-        streak++;
-    else
-        streak = 0;
 
-    symbolStreak[romaji] = streak;
-    block["symbolStreak"] = symbolStreak;
+// Spaced repetition
+ReviewState ProgressManager::getReview(bool isHiragana, int id) const
+{
+    return KanaCatalog::isValid(id) ? script(isHiragana).symbols[id].review : ReviewState();
+}
+
 
-    const int MASTER_THRESHOLD = 3;
 
-    if (streak >= MASTER_THRESHOLD)
-    {
-        QJsonArray mastered = block["mastered"].toArray();
-        if (!mastered.contains(romaji))
-            mastered.append(romaji);
+// Response times
+const LatencyHistogram &ProgressManager::latency(bool isHiragana, int id,
+                                                 AnswerHistory::Direction direction) const
+{
+    static const LatencyHistogram empty;
+
+    const int d = int(direction);
+    if (!KanaCatalog::isValid(id) || d < 0 || d >= DirectionCount)
+        return empty;
+    return script(isHiragana).symbols[id].latency[d];
+}
+
+LatencyHistogram ProgressManager::latency(bool isHiragana, int id) const
+{
+    LatencyHistogram merged;
+    if (KanaCatalog::isValid(id))
+        for (const LatencyHistogram &h : script(isHiragana).symbols[id].latency)
+            merged.merge(h);
+    return merged;
+}
+
+const LatencyHistogram &ProgressManager::scriptLatency(bool isHiragana) const
+{
+    return script(isHiragana).latency;
+}
 
-        block["mastered"] = mastered;
+// Slowest first; ties keep catalog order
+QVector<int> ProgressManager::slowestSymbols(bool isHiragana, int n, int minAnswers) const
+{
+    struct Slow { int id; int p90; };
+    QVector<Slow> slow;
+
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+    {
+        const LatencyHistogram h = latency(isHiragana, id);
+        if (h.count() >= quint64(qMax(1, minAnswers)))
+            slow.append({ id, h.percentile(90) });
     }
 
-    data[key] = block;
-    save();
+    std::stable_sort(slow.begin(), slow.end(), [](const Slow &a, const Slow &b) {
+        return a.p90 > b.p90;
+    });
+
+    QVector<int> ids;
+    for (int i = 0; i < slow.size() && (n < 0 || i < n); ++i)
+        ids.append(slow[i].id);
+    return ids;
+}
+
+
+// Confusion matrix
+int ProgressManager::getConfusion(bool isHiragana, int shownId, int chosenId) const
+{
+    if (!KanaCatalog::isValid(shownId) || !KanaCatalog::isValid(chosenId))
+        return 0;
+    return int(script(isHiragana).confusion.value(confusionKey(shownId, chosenId)));
+}
+
+// Most frequent mistakes first; ties keep catalog order
+QVector<ProgressManager::ConfusionPair> ProgressManager::topConfusedPairs(bool isHiragana, int n) const
+{
+    const QHash<quint32, quint32> &m = script(isHiragana).confusion;
+
+    QVector<ConfusionPair> pairs;
+    pairs.reserve(m.size());
+    for (auto it = m.cbegin(); it != m.cend(); ++it)
+        pairs.append({ int(it.key() >> 16), int(it.key() & 0xFFFF), int(it.value()) });
+
+    auto byCount = [](const ConfusionPair &a, const ConfusionPair &b) {
+        if (a.count != b.count)
+            return a.count > b.count;
+        return a.shownId != b.shownId ? a.shownId < b.shownId : a.chosenId < b.chosenId;
+    };
+
+    if (n >= 0 && n < pairs.size())
+    {
+        std::partial_sort(pairs.begin(), pairs.begin() + n, pairs.end(), byCount);
+        pairs.resize(n);
+    }
+    else
+    {
+        std::sort(pairs.begin(), pairs.end(), byCount);
+    }
+    return pairs;
 }
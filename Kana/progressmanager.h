@@ -3,37 +3,159 @@
 
 #include <QObject>
 #include <QJsonObject>
+#include <QVector>
+#include <QHash>
 
+#include "srsscheduler.h"
+#include "answerhistory.h"
+#include "latencyhistogram.h"
+
+class QThread;
+class QTimer;
+class ProgressStore;
+
+// Application-wide progress model. MainWindow owns the one instance and
+// hands it to the pages; views read it from memory and follow the change
+// signals instead of re-reading user_stats.json.
 class ProgressManager : public QObject
 {
     Q_OBJECT
 public:
     explicit ProgressManager(QObject *parent = nullptr);
+    // Stats snapshot at `filePath`; the journal and history sit next to it
+    explicit ProgressManager(const QString &filePath, QObject *parent = nullptr);
+    ~ProgressManager();
+
+    static QString defaultPath() { return "data/user_stats.json"; }
 
     void load();
     void save();
 
+    // One answer: updates all counters and appends a single journal record.
+    // id is a KanaCatalog id; chosenId is the wrong option picked, if any;
+    // responseMs is the time from showing the question (-1 if not measured).
+    void recordAnswer(bool isHiragana, int id, bool correct, int chosenId = -1,
+                      AnswerHistory::Direction direction = AnswerHistory::Direction::KanaToRomaji,
+                      int responseMs = -1);
+
+    // Every answer with its time, for curves and retention
+    const AnswerHistory &answerHistory() const { return history; }
+
     // practice global stats
     int  getTotalAnswered() const;
     int  getTotalCorrect()  const;
-    void addAnswered(bool correct);
-    void addPracticeAnswer(bool correct);
     // kana-specific stats
-    void addCorrect(bool isHiragana);
-    void addWrong(bool isHiragana);
     int  getCorrect(bool isHiragana) const;
     int  getWrong(bool isHiragana)  const;
     int  getStreak(bool isHiragana) const;
 
-    void markMastered(bool isHiragana, const QString &romaji);
-    void addSymbolAnswer(bool isHiragana, const QString &romaji, bool correct);
     QStringList getMastered(bool isHiragana) const;
+    bool isMastered(bool isHiragana, const QString &romaji) const;
+    bool isMastered(bool isHiragana, int id) const;
+
+    // per-symbol stats
+    int getSymbolCorrect(bool isHiragana, const QString &romaji) const;
+    int getSymbolWrong(bool isHiragana, const QString &romaji)   const;
+    int getSymbolStreak(bool isHiragana, const QString &romaji)  const;
+
+    // spaced repetition
+    ReviewState getReview(bool isHiragana, int id) const;
+
+    // response times: one symbol in one direction, one symbol in all
+    // directions, and every answer of a script
+    const LatencyHistogram &latency(bool isHiragana, int id,
+                                    AnswerHistory::Direction direction) const;
+    LatencyHistogram latency(bool isHiragana, int id) const;
+    const LatencyHistogram &scriptLatency(bool isHiragana) const;
+
+    // Symbols with the highest p90 among those timed at least minAnswers times
+    QVector<int> slowestSymbols(bool isHiragana, int n, int minAnswers = 5) const;
+
+    // confusion matrix: how often `chosenId` was picked when `shownId` was asked
+    struct ConfusionPair
+    {
+        int shownId  = -1;
+        int chosenId = -1;
+        int count    = 0;
+    };
+
+    int getConfusion(bool isHiragana, int shownId, int chosenId) const;
+    QVector<ConfusionPair> topConfusedPairs(bool isHiragana, int n) const;
+
+signals:
+    // Counters, streak or mastery of one symbol changed
+    void symbolChanged(bool isHiragana, int id);
+    // Practice totals and per-script counters changed
+    void totalsChanged();
 
 private:
+    static constexpr int DirectionCount = 3;
+
+    // In-memory model, indexed by KanaCatalog id.
+    // JSON only exists at the persistence boundary (toJson / fromJson).
+    struct SymbolStats
+    {
+        quint32 correct  = 0;
+        quint32 wrong    = 0;
+        quint16 streak   = 0;
+        bool    mastered = false;
+        ReviewState review;
+        LatencyHistogram latency[DirectionCount];
+    };
+
+    struct ScriptStats
+    {
+        int correct = 0;
+        int wrong   = 0;
+        int streak  = 0;
+        QVector<SymbolStats> symbols;
+        LatencyHistogram latency;    // merge of all symbols and directions
+
+        // Sparse shown x chosen counts, key = confusionKey(shown, chosen)
+        QHash<quint32, quint32> confusion;
+    };
+
+    static quint32 confusionKey(int shownId, int chosenId)
+    {
+        return (quint32(shownId) << 16) | quint32(chosenId);
+    }
+
+    ScriptStats &script(bool isHiragana) { return isHiragana ? hiragana : katakana; }
+    const ScriptStats &script(bool isHiragana) const { return isHiragana ? hiragana : katakana; }
+    const SymbolStats *symbol(bool isHiragana, const QString &romaji) const;
+
+    QJsonObject toJson() const;
+    void fromJson(const QJsonObject &o);
+
     QString filePath;
-    QJsonObject data;
 
-    void ensureDefaults();
+    int totalAnswered = 0;
+    int totalCorrect  = 0;
+    ScriptStats hiragana;
+    ScriptStats katakana;
+    AnswerHistory history;
+
+    // Write-behind persistence
+    QThread       *ioThread     = nullptr;
+    ProgressStore *store        = nullptr;
+    QTimer        *compactTimer = nullptr;
+    qint64         journalSeq   = 0;
+    bool           dirty        = false;
+
+    void reset();
+
+    // Counter updates behind applyAnswer(); they neither journal nor
+    // notify, so every change goes through recordAnswer()
+    void addAnswered(bool correct);
+    void addCorrect(bool isHiragana);
+    void addWrong(bool isHiragana);
+    void addSymbolAnswer(bool isHiragana, int id, bool correct);
+
+    void applyAnswer(bool isHiragana, int id, bool correct, int chosenId, qint64 when,
+                     AnswerHistory::Direction direction, int responseMs);
+    void replayJournal(qint64 snapshotSeq);
+    void markDirty();
+    void flushHistory();
 };
 
 #endif
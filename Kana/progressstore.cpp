@@ -0,0 +1,285 @@
+#include "progressstore.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// Push written bytes to the disk, not just to the OS cache
+static bool syncToDisk(int fd)
+{
+    if (fd < 0)
+        return false;
+#ifdef Q_OS_WIN
+    return _commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+static void syncDirectory(const QString &dirPath)
+{
+#ifndef Q_OS_WIN
+    int fd = ::open(QFile::encodeName(dirPath).constData(), O_RDONLY);
+    if (fd >= 0)
+    {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    Q_UNUSED(dirPath);
+#endif
+}
+
+static QByteArray checksumOf(QJsonObject o)
+{
+    o.remove("checksum");
+    return QCryptographicHash::hash(QJsonDocument(o).toJson(QJsonDocument::Compact),
+                                    QCryptographicHash::Sha256).toHex();
+}
+
+// Parses one snapshot generation; false if missing, torn or tampered
+static bool readValidSnapshot(const QString &path, QJsonObject &out)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject())
+    {
+        qDebug() << "Stats snapshot is damaged:" << path << err.errorString();
+        return false;
+    }
+
+    QJsonObject o = doc.object();
+
+    // Files written before checksums existed are trusted as-is
+    if (o.contains("checksum") &&
+        o["checksum"].toString().toLatin1() != checksumOf(o))
+    {
+        qDebug() << "Stats snapshot checksum mismatch:" << path;
+        return false;
+    }
+
+    o.remove("checksum");
+    out = o;
+    return true;
+}
+
+ProgressStore::ProgressStore(const QString &snapshotPath, QObject *parent)
+    : QObject(parent)
+    , m_snapshotPath(snapshotPath)
+{
+    m_journal.setFileName(journalPathFor(snapshotPath));
+    m_history.setFileName(historyPathFor(snapshotPath));
+}
+
+QString ProgressStore::journalPathFor(const QString &snapshotPath)
+{
+    QFileInfo fi(snapshotPath);
+    return fi.path() + "/" + fi.completeBaseName() + ".journal";
+}
+
+QString ProgressStore::backupPathFor(const QString &snapshotPath)
+{
+    return snapshotPath + ".bak";
+}
+
+QString ProgressStore::historyPathFor(const QString &snapshotPath)
+{
+    return QFileInfo(snapshotPath).path() + "/answer_history.bin";
+}
+
+
+// Startup
+QJsonObject ProgressStore::readSnapshot(const QString &snapshotPath)
+{
+    QJsonObject o;
+    if (readValidSnapshot(snapshotPath, o))
+        return o;
+
+    // Keep the damaged file around instead of overwriting it on next save
+    if (QFile::exists(snapshotPath))
+    {
+        const QString corrupt = snapshotPath + ".corrupt";
+        QFile::remove(corrupt);
+        QFile::rename(snapshotPath, corrupt);
+    }
+
+    if (readValidSnapshot(backupPathFor(snapshotPath), o))
+    {
+        qDebug() << "Restored stats from backup generation.";
+        return o;
+    }
+
+    return QJsonObject();
+}
+
+bool ProgressStore::snapshotExists(const QString &snapshotPath)
+{
+    return QFile::exists(snapshotPath) || QFile::exists(backupPathFor(snapshotPath));
+}
+
+QVector<QJsonObject> ProgressStore::readJournal(const QString &snapshotPath)
+{
+    QVector<QJsonObject> records;
+
+    QFile f(journalPathFor(snapshotPath));
+    if (!f.open(QIODevice::ReadOnly))
+        return records;
+
+    while (!f.atEnd())
+    {
+        const QByteArray line = f.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        // A torn last line (crash mid-append) is simply dropped
+        QJsonParseError err;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &err);
+        if (err.error != QJsonParseError::NoError || !doc.isObject())
+        {
+            qDebug() << "Skipping damaged journal record";
+            continue;
+        }
+        records.append(doc.object());
+    }
+    return records;
+}
+
+
+QByteArray ProgressStore::readHistory(const QString &snapshotPath)
+{
+    QFile f(historyPathFor(snapshotPath));
+    if (!f.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return f.readAll();
+}
+
+// Cuts off a torn last block so new blocks don't land behind it
+void ProgressStore::truncateHistory(const QString &snapshotPath, qint64 validBytes)
+{
+    QFile f(historyPathFor(snapshotPath));
+    if (f.exists() && f.size() > validBytes && !f.resize(validBytes))
+        qDebug() << "Cannot repair answer history!";
+}
+
+
+// Journal
+void ProgressStore::append(const QByteArray &record)
+{
+    KANA_TRACE_SCOPE("ProgressStore::append");
+
+    if (!m_journal.isOpen())
+    {
+        QDir().mkpath(QFileInfo(m_journal.fileName()).path());
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            qDebug() << "Cannot open stats journal!";
+            return;
+        }
+    }
+
+    m_journal.write(record);
+    m_journal.write("\n", 1);
+    m_journal.flush();
+}
+
+
+// History
+void ProgressStore::appendHistory(const QByteArray &block)
+{
+    KANA_TRACE_SCOPE("ProgressStore::appendHistory");
+
+    if (!m_history.isOpen())
+    {
+        QDir().mkpath(QFileInfo(m_history.fileName()).path());
+        if (!m_history.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            qDebug() << "Cannot open answer history!";
+            return;
+        }
+    }
+
+    if (m_history.write(block) != block.size() || !m_history.flush())
+        qDebug() << "Cannot write answer history!";
+}
+
+
+// Compaction
+void ProgressStore::compact(const QJsonObject &snapshot)
+{
+    KANA_TRACE_SCOPE("ProgressStore::compact");
+
+    if (!writeSnapshot(snapshot))
+        return;
+
+    // Every record up to snapshot["journalSeq"] is now folded in
+    m_journal.close();
+    QFile j(m_journal.fileName());
+    if (j.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        j.close();
+}
+
+
+// Atomic snapshot: temp file + fsync, previous generation kept as .bak
+bool ProgressStore::writeSnapshot(const QJsonObject &snapshot)
+{
+    const QString dir = QFileInfo(m_snapshotPath).path();
+    QDir().mkpath(dir);
+
+    QJsonObject o = snapshot;
+    o["checksum"] = QString::fromLatin1(checksumOf(o));
+
+    QSaveFile f(m_snapshotPath);
+    if (!f.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Cannot write stats file!";
+        return false;
+    }
+
+    const QByteArray bytes = QJsonDocument(o).toJson(QJsonDocument::Indented);
+    if (f.write(bytes) != bytes.size() || !f.flush() || !syncToDisk(f.handle()))
+    {
+        qDebug() << "Cannot write stats file!";
+        f.cancelWriting();
+        return false;
+    }
+
+    // Copy the current generation aside first: the primary file stays in
+    // place until the commit below replaces it atomically
+    const QString backup = backupPathFor(m_snapshotPath);
+    const QString pending = backup + ".tmp";
+    QFile::remove(pending);
+    const bool haveOld = QFile::exists(m_snapshotPath) && QFile::copy(m_snapshotPath, pending);
+
+    if (!f.commit())
+    {
+        qDebug() << "Cannot commit stats file!";
+        QFile::remove(pending);
+        return false;
+    }
+
+    // Only now does the previous generation become the backup
+    if (haveOld)
+    {
+        QFile::remove(backup);
+        if (!QFile::rename(pending, backup))
+            qDebug() << "Cannot update stats backup" << backup;
+    }
+
+    syncDirectory(dir);
+    return true;
+}
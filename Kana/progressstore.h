@@ -0,0 +1,45 @@
+#ifndef PROGRESSSTORE_H
+#define PROGRESSSTORE_H
+
+#include <QObject>
+#include <QFile>
+#include <QJsonObject>
+#include <QVector>
+
+// Disk side of ProgressManager.
+// Lives on a worker thread: answers are appended to a line-delimited journal
+// and compact() folds everything into the JSON snapshot, then truncates it.
+// Answer history blocks (see answerhistory.h) go to their own append-only file.
+// Snapshots are written atomically and carry a checksum; the previous
+// generation is kept as <file>.bak and used when the current one is damaged.
+class ProgressStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProgressStore(const QString &snapshotPath, QObject *parent = nullptr);
+
+    static QString journalPathFor(const QString &snapshotPath);
+    static QString backupPathFor(const QString &snapshotPath);
+    static QString historyPathFor(const QString &snapshotPath);
+
+    // Startup (called before the worker thread takes over)
+    static bool snapshotExists(const QString &snapshotPath);
+    static QJsonObject readSnapshot(const QString &snapshotPath);
+    static QVector<QJsonObject> readJournal(const QString &snapshotPath);
+    static QByteArray readHistory(const QString &snapshotPath);
+    static void truncateHistory(const QString &snapshotPath, qint64 validBytes);
+
+public slots:
+    void append(const QByteArray &record);
+    void appendHistory(const QByteArray &block);
+    void compact(const QJsonObject &snapshot);
+
+private:
+    bool writeSnapshot(const QJsonObject &snapshot);
+
+    QString m_snapshotPath;
+    QFile   m_journal;
+    QFile   m_history;
+};
+
+#endif // PROGRESSSTORE_H
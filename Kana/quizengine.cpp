@@ -0,0 +1,219 @@
+#include "quizengine.h"
+#include "kanacatalog.h"
+#include "progressmanager.h"
+#include "trace.h"
+
+#include <algorithm>
+
+// Confusion history used by the "Confused pairs" drill and look-alike options
+static const int CONFUSED_DRILL_PAIRS = 12;
+static const int CONFUSION_FEED_PAIRS = 64;
+
+
+QuizEngine::QuizEngine()
+    : m_rng(QRandomGenerator::global()->generate())
+{
+    m_all.reserve(KanaCatalog::Count * 2);
+
+    for (bool hira : { true, false })
+    {
+        for (int id = 0; id < KanaCatalog::Count; ++id)
+        {
+            QuizKanaItem it;
+            it.id = id;
+            it.kana = KanaCatalog::kana(id, hira);
+            it.romaji = KanaCatalog::romaji(id);
+            it.isHiragana = hira;
+            m_all.append(it);
+        }
+    }
+}
+
+void QuizEngine::seed(quint32 s)
+{
+    m_rng.seed(s);
+    m_distractors.seed(s);
+}
+
+const QuizKanaItem &QuizEngine::itemOf(int id, bool isHiragana) const
+{
+    return m_all[(isHiragana ? 0 : KanaCatalog::Count) + id];
+}
+
+
+// Session
+int QuizEngine::start(const PracticeConfig &config, const ProgressManager *progress,
+                      const std::function<bool(const QuizKanaItem &)> &keep)
+{
+    KANA_TRACE_SCOPE("QuizEngine::start");
+
+    m_config = config;
+    m_pool.clear();
+    m_current = QuizKanaItem();
+    m_hasNext = false;
+
+    if (m_config.source == PracticeConfig::Source::Confused)
+        buildConfusedPool(progress);
+    else
+    {
+        for (const auto &it : m_all)
+        {
+            if (m_config.script == PracticeConfig::Script::Hiragana && !it.isHiragana)
+                continue;
+            if (m_config.script == PracticeConfig::Script::Katakana && it.isHiragana)
+                continue;
+
+            if (m_config.source == PracticeConfig::Source::Mastered)
+            {
+                if (!progress->isMastered(it.isHiragana, it.id))
+                    continue;
+            }
+
+            m_pool.append(it);
+        }
+    }
+
+    if (keep)
+        m_pool.erase(std::remove_if(m_pool.begin(), m_pool.end(),
+                                    [&keep](const QuizKanaItem &it) { return !keep(it); }),
+                     m_pool.end());
+
+    if (m_pool.isEmpty())
+        return 0;
+
+    QVector<int> hiraIds, kataIds;
+    for (const auto &it : m_pool)
+        (it.isHiragana ? hiraIds : kataIds).append(it.id);
+
+    m_distractors.setPool(hiraIds, kataIds);
+
+    // The confused-pairs drill only makes sense with the partner as an option
+    const bool confusable =
+        m_config.distractors == PracticeConfig::Distractors::LookAlike ||
+        m_config.source == PracticeConfig::Source::Confused;
+    m_distractors.setMode(confusable ? DistractorSampler::Mode::Confusable
+                                     : DistractorSampler::Mode::Uniform);
+
+    // The learner's own mistakes, on top of the built-in look-alikes
+    m_distractors.clearConfusions();
+    for (bool hira : { true, false })
+        for (const auto &p : progress->topConfusedPairs(hira, CONFUSION_FEED_PAIRS))
+            m_distractors.addConfusion(hira, p.shownId, p.chosenId, p.count);
+
+    if (m_config.source == PracticeConfig::Source::Due)
+    {
+        m_scheduler.clear();
+        for (const auto &it : m_pool)
+            m_scheduler.schedule(it.id, it.isHiragana,
+                                 progress->getReview(it.isHiragana, it.id).due);
+    }
+
+    return m_pool.size();
+}
+
+// Both sides of the most frequent mistakes, in the selected scripts.
+// A pair that was confused more often shows up more often.
+void QuizEngine::buildConfusedPool(const ProgressManager *progress)
+{
+    for (bool hira : { true, false })
+    {
+        if (m_config.script == PracticeConfig::Script::Hiragana && !hira)
+            continue;
+        if (m_config.script == PracticeConfig::Script::Katakana && hira)
+            continue;
+
+        for (const auto &p : progress->topConfusedPairs(hira, CONFUSED_DRILL_PAIRS))
+        {
+            const int weight = qMin(p.count, 3);
+            for (int i = 0; i < weight; ++i)
+            {
+                m_pool.append(itemOf(p.shownId, hira));
+                m_pool.append(itemOf(p.chosenId, hira));
+            }
+        }
+    }
+}
+
+
+// Question order
+QuizKanaItem QuizEngine::pickItem()
+{
+    if (m_config.source == PracticeConfig::Source::Due)
+        return nextDueItem();
+
+    return m_pool[m_rng.bounded(m_pool.size())];
+}
+
+// Spaced repetition: earliest due symbol, never the same one twice in a row
+QuizKanaItem QuizEngine::nextDueItem()
+{
+    SrsScheduler::Item next;
+    if (!m_scheduler.takeNext(next, m_current.id, m_current.isHiragana))
+        return m_pool[m_rng.bounded(m_pool.size())];
+
+    return itemOf(next.id, next.isHiragana);
+}
+
+const QuizKanaItem &QuizEngine::lookAhead()
+{
+    m_next = pickItem();
+    m_hasNext = true;
+    return m_next;
+}
+
+void QuizEngine::answered(const QuizKanaItem &item, const ProgressManager *progress)
+{
+    if (m_config.source == PracticeConfig::Source::Due)
+        m_scheduler.schedule(item.id, item.isHiragana,
+                             progress->getReview(item.isHiragana, item.id).due);
+}
+
+
+// Prepare question: everything random or computed for the next question,
+// done right after an answer so showing it is just a swap
+void QuizEngine::prepare(PreparedQuestion &q)
+{
+    KANA_TRACE_SCOPE("QuizEngine::prepare");
+
+    q.item = m_hasNext ? m_next : pickItem();
+    m_hasNext = false;
+
+    if (m_config.mode == PracticeConfig::Mode::KanaToRomaji)
+        q.showKana = true;
+    else if (m_config.mode == PracticeConfig::Mode::RomajiToKana ||
+             m_config.mode == PracticeConfig::Mode::AudioToKana)
+        q.showKana = false;
+    else
+        q.showKana = m_rng.bounded(2);
+
+    q.correctIndex = m_rng.bounded(4);
+    q.optionIds[q.correctIndex] = q.item.id;
+    q.optionText[q.correctIndex] = q.showKana ? q.item.romaji : q.item.kana;
+
+    // Kana options must stay in the question's script; a spoken prompt
+    // must not have a homophone of the answer among them
+    const bool audio = m_config.mode == PracticeConfig::Mode::AudioToKana;
+    int distractors[3];
+    const int found = m_distractors.draw(q.item.id, q.item.isHiragana,
+                                         !q.showKana, 3, distractors, audio);
+
+    for (int i = 0, d = 0; i < 4; ++i)
+    {
+        if (i == q.correctIndex)
+            continue;
+
+        if (d >= found)
+        {
+            q.optionIds[i] = -1;
+            q.optionText[i] = "—";
+            continue;
+        }
+
+        const int id = distractors[d++];
+        q.optionIds[i] = id;
+        q.optionText[i] = q.showKana ? KanaCatalog::romaji(id)
+                                     : KanaCatalog::kana(id, q.item.isHiragana);
+    }
+
+    q.ready = true;
+}
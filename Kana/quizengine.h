@@ -0,0 +1,86 @@
+#ifndef QUIZENGINE_H
+#define QUIZENGINE_H
+
+#include <QString>
+#include <QVector>
+#include <QRandomGenerator>
+#include <functional>
+
+#include "practiceconfig.h"
+#include "srsscheduler.h"
+#include "distractorsampler.h"
+
+class ProgressManager;
+
+struct QuizKanaItem
+{
+    int     id = -1;     // KanaCatalog id
+    QString kana;
+    QString romaji;
+    bool    isHiragana = true;
+};
+
+// A question built ahead of time; showing it only copies these into the UI
+struct PreparedQuestion
+{
+    QuizKanaItem item;
+    bool    showKana = true;
+    int     correctIndex = 0;
+    int     optionIds[4] = { -1, -1, -1, -1 };
+    QString optionText[4];
+    bool    ready = false;
+};
+
+// Quiz logic without any UI: session pool, question order (random or
+// spaced repetition), one-item lookahead and answer options.
+// PracticeSessionPage drives it; kana_bench runs it headless.
+class QuizEngine
+{
+public:
+    QuizEngine();
+
+    void seed(quint32 s);
+
+    // New session. `keep` can drop items the UI can't ask (no sound clip).
+    // Returns the pool size; 0 means there is nothing to practise.
+    int start(const PracticeConfig &config, const ProgressManager *progress,
+              const std::function<bool(const QuizKanaItem &)> &keep = {});
+
+    const PracticeConfig &config() const { return m_config; }
+    int poolSize() const { return m_pool.size(); }
+
+    // Fills `q`, consuming the lookahead item if there is one
+    void prepare(PreparedQuestion &q);
+
+    // The question now on screen; the lookahead avoids repeating it
+    void setCurrent(const QuizKanaItem &item) { m_current = item; }
+
+    // Picks the item after the current one (so its clip can be preloaded)
+    const QuizKanaItem &lookAhead();
+    bool hasLookAhead() const { return m_hasNext; }
+
+    // After an answer: due symbols are rescheduled
+    void answered(const QuizKanaItem &item, const ProgressManager *progress);
+
+    const QuizKanaItem &itemOf(int id, bool isHiragana) const;
+
+private:
+    void buildConfusedPool(const ProgressManager *progress);
+    QuizKanaItem pickItem();
+    QuizKanaItem nextDueItem();
+
+    PracticeConfig m_config;
+    QRandomGenerator m_rng;
+
+    QVector<QuizKanaItem> m_all;
+    QVector<QuizKanaItem> m_pool;
+
+    QuizKanaItem m_current;
+    QuizKanaItem m_next;
+    bool         m_hasNext = false;
+
+    SrsScheduler m_scheduler;
+    DistractorSampler m_distractors;
+};
+
+#endif // QUIZENGINE_H
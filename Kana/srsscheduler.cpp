@@ -0,0 +1,112 @@
+#include "srsscheduler.h"
+#include "kanacatalog.h"
+
+#include <algorithm>
+
+static const qint32 DAY_SECS       = 24 * 60 * 60;
+static const qint32 RELEARN_SECS   = 60;          // wrong answers come back soon
+static const qint32 MAX_INTERVAL   = 365 * DAY_SECS;
+static const float  MIN_EASE       = 1.3f;
+
+int SrsScheduler::slotOf(int id, bool isHiragana)
+{
+    return id * 2 + (isHiragana ? 0 : 1);
+}
+
+void SrsScheduler::clear()
+{
+    m_heap = decltype(m_heap)();
+    m_version.fill(0, KanaCatalog::Count * 2);
+    m_queued.fill(false, KanaCatalog::Count * 2);
+    m_live = 0;
+}
+
+void SrsScheduler::schedule(int id, bool isHiragana, qint64 due)
+{
+    if (!KanaCatalog::isValid(id))
+        return;
+
+    if (m_version.isEmpty())
+        clear();
+
+    const int slot = slotOf(id, isHiragana);
+    if (!m_queued[slot])
+    {
+        m_queued[slot] = true;
+        m_live++;
+    }
+
+    m_heap.push({ due, slot, ++m_version[slot] });
+}
+
+bool SrsScheduler::isEmpty() const
+{
+    return m_live == 0;
+}
+
+bool SrsScheduler::popValid(Entry &out)
+{
+    while (!m_heap.empty())
+    {
+        const Entry e = m_heap.top();
+        m_heap.pop();
+
+        if (!m_queued[e.slot] || e.version != m_version[e.slot])
+            continue;   // superseded by a later schedule()
+
+        m_queued[e.slot] = false;
+        m_live--;
+        out = e;
+        return true;
+    }
+    return false;
+}
+
+bool SrsScheduler::takeNext(Item &out, int avoidId, bool avoidHiragana)
+{
+    Entry e;
+    if (!popValid(e))
+        return false;
+
+    if (KanaCatalog::isValid(avoidId) && e.slot == slotOf(avoidId, avoidHiragana))
+    {
+        Entry other;
+        if (popValid(other))
+        {
+            schedule(avoidId, avoidHiragana, e.due);
+            e = other;
+        }
+    }
+
+    out.id = e.slot / 2;
+    out.isHiragana = (e.slot % 2) == 0;
+    out.due = e.due;
+    return true;
+}
+
+
+// SM-2 with a binary grade: correct = 4, wrong = 1
+ReviewState SrsScheduler::grade(ReviewState s, bool correct, qint64 now)
+{
+    const int q = correct ? 4 : 1;
+    s.ease = std::max(MIN_EASE, s.ease + 0.1f - (5 - q) * (0.08f + (5 - q) * 0.02f));
+
+    if (correct)
+    {
+        if (s.reps == 0)
+            s.interval = DAY_SECS;
+        else if (s.reps == 1)
+            s.interval = 6 * DAY_SECS;
+        else
+            s.interval = qint32(std::min<qint64>(MAX_INTERVAL, qint64(s.interval * s.ease)));
+        s.reps++;
+    }
+    else
+    {
+        s.reps = 0;
+        s.interval = RELEARN_SECS;
+    }
+
+    s.due = now + s.interval;
+    return s;
+}
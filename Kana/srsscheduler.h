@@ -0,0 +1,67 @@
+#ifndef SRSSCHEDULER_H
+#define SRSSCHEDULER_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// Spaced-repetition state of one symbol in one script (SM-2 style)
+struct ReviewState
+{
+    qint64  due      = 0;      // epoch seconds, 0 = never seen
+    qint32  interval = 0;      // seconds
+    float   ease     = 2.5f;
+    quint16 reps     = 0;      // successful reviews in a row
+
+    bool isNew() const { return reps == 0 && due == 0; }
+};
+
+// Picks the next practice item by due time.
+// Items live in a min-heap keyed by (due, slot); rescheduling pushes a new
+// entry and stale ones are dropped lazily, so both operations are O(log n).
+class SrsScheduler
+{
+public:
+    struct Item
+    {
+        int  id = -1;          // KanaCatalog id
+        bool isHiragana = true;
+        qint64 due = 0;
+    };
+
+    void clear();
+    void schedule(int id, bool isHiragana, qint64 due);
+    bool isEmpty() const;
+
+    // Removes and returns the earliest-due item; the avoided one (usually
+    // the question just asked) is only returned when nothing else is queued
+    bool takeNext(Item &out, int avoidId = -1, bool avoidHiragana = true);
+
+    // SM-2 update for a binary answer at time `now`
+    static ReviewState grade(ReviewState s, bool correct, qint64 now);
+
+private:
+    struct Entry
+    {
+        qint64  due;
+        int     slot;
+        quint32 version;
+
+        bool operator>(const Entry &o) const
+        {
+            return due != o.due ? due > o.due : slot > o.slot;
+        }
+    };
+
+    static int slotOf(int id, bool isHiragana);
+    bool popValid(Entry &out);
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_heap;
+    QVector<quint32> m_version;   // per slot; entries with an older one are stale
+    QVector<bool>    m_queued;
+    int m_live = 0;
+};
+
+#endif // SRSSCHEDULER_H
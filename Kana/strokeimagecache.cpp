@@ -0,0 +1,156 @@
+#include "strokeimagecache.h"
+#include "assetpack.h"
+#include "kanacatalog.h"
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QPixmapCache>
+#include <QThreadPool>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QFile>
+#include <QDebug>
+
+// Sizes are rounded down to this step, so resizing reuses pixmaps
+static const int BUCKET_STEP = 32;
+
+static const int PIXMAP_CACHE_KB  = 32 * 1024;
+static const int SOURCE_CACHE_KB  = 24 * 1024;
+
+
+StrokeImageCache *StrokeImageCache::instance()
+{
+    static StrokeImageCache *cache = new StrokeImageCache(QCoreApplication::instance());
+    return cache;
+}
+
+StrokeImageCache::StrokeImageCache(QObject *parent)
+    : QObject(parent)
+{
+    if (QPixmapCache::cacheLimit() < PIXMAP_CACHE_KB)
+        QPixmapCache::setCacheLimit(PIXMAP_CACHE_KB);
+
+    m_sources.setMaxCost(SOURCE_CACHE_KB);
+}
+
+
+// Keys
+QString StrokeImageCache::pathFor(bool isHiragana, const QString &romaji)
+{
+    return QString("data/strokes/%1%2.jpg").arg(isHiragana ? "hira_" : "kata_", romaji);
+}
+
+QSize StrokeImageCache::bucketFor(const QSize &target)
+{
+    auto round = [](int v) { return qMax(BUCKET_STEP, v / BUCKET_STEP * BUCKET_STEP); };
+    return QSize(round(target.width()), round(target.height()));
+}
+
+QString StrokeImageCache::keyFor(bool isHiragana, const QString &romaji, const QSize &bucket)
+{
+    return QString("stroke:%1:%2:%3x%4")
+        .arg(isHiragana ? "h" : "k")
+        .arg(romaji)
+        .arg(bucket.width())
+        .arg(bucket.height());
+}
+
+bool StrokeImageCache::hasImage(bool isHiragana, const QString &romaji)
+{
+    const AssetPack *pack = AssetPack::instance();
+    if (pack->isOpen())
+        return pack->contains(AssetPack::strokeKind(isHiragana), KanaCatalog::idOfRomaji(romaji));
+
+    const QString path = pathFor(isHiragana, romaji);
+
+    auto it = m_exists.constFind(path);
+    if (it == m_exists.constEnd())
+        it = m_exists.insert(path, QFile::exists(path));
+    return it.value();
+}
+
+
+// Lookup
+bool StrokeImageCache::pixmap(bool isHiragana, const QString &romaji, const QSize &target,
+                              QPixmap *out)
+{
+    const QSize bucket = bucketFor(target);
+    const QString key = keyFor(isHiragana, romaji, bucket);
+
+    if (QPixmapCache::find(key, out))
+        return true;
+
+    request(isHiragana, romaji, bucket, key);
+    return false;
+}
+
+void StrokeImageCache::prefetch(bool isHiragana, const QString &romaji, const QSize &target)
+{
+    QPixmap unused;
+    pixmap(isHiragana, romaji, target, &unused);
+}
+
+
+// Decode + scale on the thread pool, insert on the GUI thread
+void StrokeImageCache::request(bool isHiragana, const QString &romaji, const QSize &bucket,
+                               const QString &key)
+{
+    if (m_pending.contains(key) || !hasImage(isHiragana, romaji))
+        return;
+
+    m_pending.insert(key);
+
+    QPointer<StrokeImageCache> self(this);
+
+    QThreadPool::globalInstance()->start([this, self, isHiragana, romaji, bucket, key]() {
+        KANA_TRACE_SCOPE("StrokeImageCache::decode");
+
+        QImage img = source(isHiragana, romaji);
+        if (!img.isNull())
+            img = img.scaled(bucket, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+        QMetaObject::invokeMethod(self, [self, img, key]() {
+            if (!self)
+                return;
+
+            self->m_pending.remove(key);
+            if (img.isNull())
+            {
+                qDebug() << "Stroke image failed to decode:" << key;
+                return;
+            }
+
+            QPixmapCache::insert(key, QPixmap::fromImage(img));
+            emit self->ready(key);
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Runs on a pool thread
+QImage StrokeImageCache::source(bool isHiragana, const QString &romaji)
+{
+    const QString path = pathFor(isHiragana, romaji);
+    {
+        QMutexLocker lock(&m_sourceMutex);
+        if (QImage *img = m_sources.object(path))
+            return *img;
+    }
+
+    // Decoded straight from the mapped pack, no file I/O
+    QImage img;
+    const QByteArray packed = AssetPack::instance()->data(
+        AssetPack::strokeKind(isHiragana), KanaCatalog::idOfRomaji(romaji));
+
+    if (!packed.isEmpty())
+        img = QImage::fromData(packed, "JPG");
+    else
+        img = QImageReader(path).read();
+
+    if (img.isNull())
+        return img;
+
+    QMutexLocker lock(&m_sourceMutex);
+    m_sources.insert(path, new QImage(img), qMax<qsizetype>(1, img.sizeInBytes() / 1024));
+    return img;
+}
@@ -0,0 +1,54 @@
+#ifndef STROKEIMAGECACHE_H
+#define STROKEIMAGECACHE_H
+
+#include <QObject>
+#include <QPixmap>
+#include <QImage>
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+
+// Application-wide cache for the stroke order images (asset pack, or
+// data/strokes/ when there is no pack).
+// JPGs are decoded and scaled on the global thread pool; the results live in
+// QPixmapCache keyed by (script, romaji, size bucket), so the detail dialog
+// only ever blits a ready pixmap. Callers get `ready(key)` once a requested
+// pixmap has been inserted.
+class StrokeImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StrokeImageCache *instance();
+
+    static QString pathFor(bool isHiragana, const QString &romaji);
+    static QSize   bucketFor(const QSize &target);
+    static QString keyFor(bool isHiragana, const QString &romaji, const QSize &bucket);
+
+    bool hasImage(bool isHiragana, const QString &romaji);
+
+    // Pixmap scaled for `target` (rounded down to its bucket).
+    // On a miss the decode is scheduled and false is returned.
+    bool pixmap(bool isHiragana, const QString &romaji, const QSize &target, QPixmap *out);
+    void prefetch(bool isHiragana, const QString &romaji, const QSize &target);
+
+signals:
+    void ready(const QString &key);
+
+private:
+    explicit StrokeImageCache(QObject *parent = nullptr);
+
+    void request(bool isHiragana, const QString &romaji, const QSize &bucket,
+                 const QString &key);
+    QImage source(bool isHiragana, const QString &romaji);
+
+    QHash<QString, bool> m_exists;    // loose file path -> present
+    QSet<QString>        m_pending;   // keys being decoded
+
+    // Decoded originals, so a new size bucket doesn't hit the disk again
+    QMutex                  m_sourceMutex;
+    QCache<QString, QImage> m_sources;
+};
+
+#endif // STROKEIMAGECACHE_H
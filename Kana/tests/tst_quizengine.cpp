@@ -0,0 +1,93 @@
+// Quiz engine checks that need no GUI; built with kana_core and QtTest.
+#include "quizengine.h"
+#include "distractorsampler.h"
+#include "progressmanager.h"
+#include "kanacatalog.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+class TestQuizEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void homophonesShareASound();
+    void samplerSkipsHomophones();
+    void listeningOptionsSoundDifferent();
+};
+
+void TestQuizEngine::homophonesShareASound()
+{
+    const int ji   = KanaCatalog::idOfRomaji("ji");
+    const int jiDi = KanaCatalog::idOfRomaji("ji(di)");
+    const int zu   = KanaCatalog::idOfRomaji("zu");
+    const int zuDu = KanaCatalog::idOfRomaji("zu(du)");
+    QVERIFY(ji >= 0 && jiDi >= 0 && zu >= 0 && zuDu >= 0);
+
+    QCOMPARE(DistractorSampler::soundOf(ji), DistractorSampler::soundOf(jiDi));
+    QCOMPARE(DistractorSampler::soundOf(zu), DistractorSampler::soundOf(zuDu));
+    QVERIFY(DistractorSampler::soundOf(ji) != DistractorSampler::soundOf(zu));
+}
+
+// A pool made of nothing but the answer's homophone still yields none
+void TestQuizEngine::samplerSkipsHomophones()
+{
+    const int ji   = KanaCatalog::idOfRomaji("ji");
+    const int jiDi = KanaCatalog::idOfRomaji("ji(di)");
+
+    DistractorSampler sampler;
+    sampler.seed(1);
+    sampler.setPool({ ji, jiDi }, {});
+
+    for (int round = 0; round < 200; ++round)
+    {
+        for (int target : { ji, jiDi })
+        {
+            int out[3];
+            const int n = sampler.draw(target, true, true, 3, out, true);
+            QCOMPARE(n, 3);
+            for (int i = 0; i < n; ++i)
+                QVERIFY(DistractorSampler::soundOf(out[i]) != DistractorSampler::soundOf(target));
+        }
+    }
+}
+
+void TestQuizEngine::listeningOptionsSoundDifferent()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ProgressManager progress(dir.filePath("user_stats.json"));
+
+    for (auto distractors : { PracticeConfig::Distractors::Random,
+                              PracticeConfig::Distractors::LookAlike })
+    {
+        PracticeConfig config;
+        config.mode = PracticeConfig::Mode::AudioToKana;
+        config.distractors = distractors;
+
+        QuizEngine engine;
+        engine.seed(7);
+        QVERIFY(engine.start(config, &progress) > 0);
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            PreparedQuestion q;
+            engine.prepare(q);
+            engine.setCurrent(q.item);
+
+            const QString sound = KanaCatalog::displayRomaji(q.item.id);
+            for (int o = 0; o < 4; ++o)
+            {
+                if (o == q.correctIndex || q.optionIds[o] < 0)
+                    continue;
+                QVERIFY2(KanaCatalog::displayRomaji(q.optionIds[o]) != sound,
+                         qPrintable(KanaCatalog::romaji(q.item.id) + " offered with " +
+                                    KanaCatalog::romaji(q.optionIds[o])));
+            }
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestQuizEngine)
+#include "tst_quizengine.moc"
@@ -0,0 +1,267 @@
+// Online word service against a local stand-in: page cache, TTL and
+// collapsing of clicks while a reply is out.
+#include "WordApiService.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkProxy>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QUrlQuery>
+#include <QtTest>
+
+#include <memory>
+
+// Minimal search endpoint: five jisho-shaped words per keyword, none for
+// "zzz". Replies can be held back to keep a request in flight.
+class StandIn : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StandIn(QObject *parent = nullptr) : QObject(parent)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, &StandIn::accept);
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost); }
+    QUrl url() const
+    {
+        return QUrl(QString("http://127.0.0.1:%1/search").arg(m_server.serverPort()));
+    }
+
+    int  requests = 0;
+    bool hold = false;
+
+    void release()
+    {
+        hold = false;
+        const auto held = m_held;
+        m_held.clear();
+        for (const auto &h : held)
+            if (h.first)
+                reply(h.first, h.second);
+    }
+
+private:
+    void accept()
+    {
+        while (QTcpSocket *s = m_server.nextPendingConnection())
+        {
+            connect(s, &QTcpSocket::disconnected, s, &QObject::deleteLater);
+            connect(s, &QTcpSocket::readyRead, this, [this, s]() { read(s); });
+        }
+    }
+
+    void read(QTcpSocket *s)
+    {
+        QByteArray &buf = m_buffers[s];
+        buf += s->readAll();
+        if (!buf.contains("\r\n\r\n"))
+            return;
+
+        // "GET /search?keyword=... HTTP/1.1"
+        const QByteArray target = buf.split(' ').value(1);
+        m_buffers.remove(s);
+        ++requests;
+
+        const QUrl u(QString::fromLatin1("http://stand.in") + QString::fromLatin1(target));
+        const QString keyword = QUrlQuery(u).queryItemValue("keyword", QUrl::FullyDecoded);
+
+        if (hold)
+            m_held.append({ s, keyword });
+        else
+            reply(s, keyword);
+    }
+
+    void reply(QTcpSocket *s, const QString &keyword)
+    {
+        QJsonArray data;
+        for (int i = 0; keyword != "zzz" && i < 5; ++i)
+        {
+            const QString reading = keyword + QString::number(i);
+            data.append(QJsonObject{
+                { "slug", reading },
+                { "japanese", QJsonArray{ QJsonObject{ { "reading", reading },
+                                                       { "word", reading } } } },
+                { "senses", QJsonArray{ QJsonObject{
+                    { "english_definitions", QJsonArray{ "meaning " + reading } } } } },
+            });
+        }
+
+        const QByteArray body = QJsonDocument(QJsonObject{ { "data", data } }).toJson(QJsonDocument::Compact);
+        s->write("HTTP/1.1 200 OK\r\n"
+                 "Content-Type: application/json\r\n"
+                 "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                 "Connection: close\r\n\r\n" + body);
+        s->disconnectFromHost();
+    }
+
+    QTcpServer                                  m_server;
+    QHash<QTcpSocket*, QByteArray>              m_buffers;
+    QList<QPair<QPointer<QTcpSocket>, QString>> m_held;
+};
+
+class TestWordApiService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void repeatedFetchUsesOnePage();
+    void diskCacheSurvivesRestart();
+    void expiredTtlRefetches();
+    void rapidClicksCollapse();
+    void searchWhilePending();
+    void searchWhilePendingNoHit();
+
+private:
+    std::unique_ptr<WordApiService> service() const;
+
+    StandIn                        m_server;
+    std::unique_ptr<QTemporaryDir> m_dir;
+};
+
+void TestWordApiService::initTestCase()
+{
+    QNetworkProxy::setApplicationProxy(QNetworkProxy::NoProxy);
+    QVERIFY(m_server.listen());
+}
+
+void TestWordApiService::init()
+{
+    m_dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_dir->isValid());
+
+    m_server.release();
+    m_server.requests = 0;
+}
+
+std::unique_ptr<WordApiService> TestWordApiService::service() const
+{
+    auto s = std::make_unique<WordApiService>();
+    s->setBaseUrl(m_server.url());
+    s->setCacheDir(m_dir->path());
+    s->setOfflineEnabled(false);
+    return s;
+}
+
+void TestWordApiService::repeatedFetchUsesOnePage()
+{
+    auto s = service();
+    QSignalSpy words(s.get(), &WordApiService::wordReady);
+
+    s->fetchWord();
+    QTRY_COMPARE(words.count(), 1);
+
+    // The rest of the page is handed out without asking again
+    s->fetchWord();
+    s->fetchWord();
+    QCOMPARE(words.count(), 3);
+    QCOMPARE(s->networkRequests(), 1);
+    QCOMPARE(m_server.requests, 1);
+}
+
+void TestWordApiService::diskCacheSurvivesRestart()
+{
+    {
+        auto s = service();
+        QSignalSpy words(s.get(), &WordApiService::wordReady);
+        s->fetchWord();
+        QTRY_COMPARE(words.count(), 1);
+    }
+
+    auto s = service();
+    QSignalSpy words(s.get(), &WordApiService::wordReady);
+    s->fetchWord();
+
+    QCOMPARE(words.count(), 1);
+    QCOMPARE(s->networkRequests(), 0);
+    QCOMPARE(m_server.requests, 1);
+}
+
+void TestWordApiService::expiredTtlRefetches()
+{
+    {
+        auto s = service();
+        QSignalSpy words(s.get(), &WordApiService::wordReady);
+        s->fetchWord();
+        QTRY_COMPARE(words.count(), 1);
+    }
+
+    auto s = service();
+    s->setCacheTtl(0);
+    QSignalSpy words(s.get(), &WordApiService::wordReady);
+    s->fetchWord();
+
+    QCOMPARE(words.count(), 0);
+    QTRY_COMPARE(words.count(), 1);
+    QCOMPARE(s->networkRequests(), 1);
+    QCOMPARE(m_server.requests, 2);
+}
+
+void TestWordApiService::rapidClicksCollapse()
+{
+    auto s = service();
+    QSignalSpy words(s.get(), &WordApiService::wordReady);
+
+    m_server.hold = true;
+    for (int i = 0; i < 5; ++i)
+        s->fetchWord();
+    QTRY_COMPARE(m_server.requests, 1);
+    QCOMPARE(words.count(), 0);
+
+    m_server.release();
+    QTRY_COMPARE(words.count(), 1);
+
+    QTest::qWait(200);
+    QCOMPARE(words.count(), 1);
+    QCOMPARE(s->networkRequests(), 1);
+}
+
+void TestWordApiService::searchWhilePending()
+{
+    auto s = service();
+    QSignalSpy words(s.get(), &WordApiService::wordReady);
+    QSignalSpy misses(s.get(), &WordApiService::noWordFound);
+
+    m_server.hold = true;
+    s->fetchWord();
+    QTRY_COMPARE(m_server.requests, 1);
+
+    // Answered after the seed reply, by the search and not by that reply
+    s->searchWord("ねこ");
+    m_server.release();
+
+    QTRY_COMPARE(words.count(), 1);
+    QVERIFY(words.first().first().toString().startsWith("ねこ"));
+
+    QTest::qWait(200);
+    QCOMPARE(words.count(), 1);
+    QCOMPARE(misses.count(), 0);
+    QCOMPARE(s->networkRequests(), 2);
+}
+
+void TestWordApiService::searchWhilePendingNoHit()
+{
+    auto s = service();
+    QSignalSpy words(s.get(), &WordApiService::wordReady);
+    QSignalSpy misses(s.get(), &WordApiService::noWordFound);
+
+    m_server.hold = true;
+    s->fetchWord();
+    QTRY_COMPARE(m_server.requests, 1);
+
+    s->searchWord("zzz");
+    m_server.release();
+
+    QTRY_COMPARE(misses.count(), 1);
+    QCOMPARE(misses.first().first().toString(), QString("zzz"));
+    QCOMPARE(words.count(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestWordApiService)
+#include "tst_wordapiservice.moc"
@@ -0,0 +1,106 @@
+// Offline word dictionary: build step, prefix indexes and the mastered filter.
+#include "worddictionary.h"
+#include "kanacatalog.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class TestWordDictionary : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void findByKana();
+    void findByKanaFoldsKatakana();
+    void findByRomaji();
+    void limitAndMisses();
+    void masteredFilter();
+
+private:
+    QStringList readings(const QVector<int> &hits) const;
+
+    QTemporaryDir  m_dir;
+    WordDictionary m_dict;
+};
+
+void TestWordDictionary::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    const QString tsv = m_dir.filePath("words.tsv");
+    QFile f(tsv);
+    QVERIFY(f.open(QIODevice::WriteOnly));
+    f.write("# reading\twritten\tmeaning\n"
+            "あい\t愛\tlove\n"
+            "あお\t青\tblue\n"
+            "あか\t赤\tred\n"
+            "いえ\t家\thouse\n"
+            "アイス\tアイス\tice cream\n"
+            "かさ\t傘\tumbrella\n");
+    f.close();
+
+    const QString dict = m_dir.filePath("words.dict");
+    QVERIFY(WordDictionary::build(tsv, dict));
+    QVERIFY(m_dict.open(dict));
+    QCOMPARE(m_dict.size(), 6);
+}
+
+QStringList TestWordDictionary::readings(const QVector<int> &hits) const
+{
+    QStringList out;
+    for (int i : hits)
+        out.append(m_dict.word(i).reading);
+    return out;
+}
+
+void TestWordDictionary::findByKana()
+{
+    QCOMPARE(readings(m_dict.findByKana("あか")), QStringList({ "あか" }));
+
+    // Sorted by reading; アイス is keyed as あいす
+    QCOMPARE(readings(m_dict.findByKana("あ")),
+             QStringList({ "あい", "アイス", "あお", "あか" }));
+}
+
+void TestWordDictionary::findByKanaFoldsKatakana()
+{
+    QCOMPARE(readings(m_dict.findByKana("アイ")), QStringList({ "あい", "アイス" }));
+}
+
+void TestWordDictionary::findByRomaji()
+{
+    QCOMPARE(readings(m_dict.findByRomaji("ka")), QStringList({ "かさ" }));
+    QCOMPARE(readings(m_dict.findByRomaji("AI")), QStringList({ "あい", "アイス" }));
+}
+
+void TestWordDictionary::limitAndMisses()
+{
+    QCOMPARE(m_dict.findByKana("あ", 2).size(), 2);
+    QVERIFY(m_dict.findByKana("ん").isEmpty());
+    QVERIFY(m_dict.findByRomaji("zz").isEmpty());
+    QVERIFY(m_dict.findByKana("").isEmpty());
+}
+
+void TestWordDictionary::masteredFilter()
+{
+    KanaSet mastered;
+    mastered.insert(true, KanaCatalog::idOfRomaji("a"));
+    mastered.insert(true, KanaCatalog::idOfRomaji("i"));
+
+    // Only あい is spelled with あ and い alone (アイス is katakana)
+    for (int round = 0; round < 50; ++round)
+    {
+        const int index = m_dict.randomWord(&mastered);
+        QVERIFY(index >= 0);
+        QCOMPARE(m_dict.word(index).reading, QString("あい"));
+    }
+
+    // ...and avoiding it leaves nothing
+    const int ai = m_dict.findByKana("あい", 1).value(0, -1);
+    QCOMPARE(m_dict.randomWord(&mastered, ai), -1);
+}
+
+QTEST_GUILESS_MAIN(TestWordDictionary)
+#include "tst_worddictionary.moc"
@@ -0,0 +1,28 @@
+// Build step for the bundled data
+//   kana_assetpack <data dir> <output .pak>         strokes + sounds
+//   kana_assetpack --words <words.tsv> <output .dict>   word dictionary
+
+#include "../assetpack.h"
+#include "../worddictionary.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+
+    if (args.size() == 4 && args[1] == "--words")
+        return WordDictionary::build(args[2], args[3]) ? 0 : 1;
+
+    if (args.size() != 3)
+    {
+        QTextStream(stderr) << "usage: kana_assetpack <data dir> <output .pak>\n"
+                               "       kana_assetpack --words <words.tsv> <output .dict>\n";
+        return 2;
+    }
+
+    return AssetPack::build(args[1], args[2]) ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+// Headless throughput baseline for the quiz engine and progress storage
+//   kana_bench [answers]      (default 100000)
+
+#include "../quizengine.h"
+#include "../progressmanager.h"
+#include "../kanacatalog.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+namespace
+{
+    QTextStream &out()
+    {
+        static QTextStream s(stdout);
+        return s;
+    }
+
+    void report(const char *name, qint64 ops, qint64 nsecs)
+    {
+        const double perOp = ops ? double(nsecs) / ops : 0.0;
+        const double perSec = nsecs ? ops * 1e9 / nsecs : 0.0;
+
+        out() << qSetFieldWidth(28) << Qt::left << name << qSetFieldWidth(0)
+              << qSetFieldWidth(10) << Qt::right << ops << qSetFieldWidth(0) << " ops  "
+              << qSetFieldWidth(12) << QString::number(perOp, 'f', 1) << qSetFieldWidth(0) << " ns/op  "
+              << qSetFieldWidth(12) << QString::number(perSec, 'f', 0) << qSetFieldWidth(0) << " ops/s"
+              << Qt::endl;
+    }
+
+    PracticeConfig config(PracticeConfig::Source source, PracticeConfig::Distractors d)
+    {
+        PracticeConfig c;
+        c.mode = PracticeConfig::Mode::Mixed;
+        c.script = PracticeConfig::Script::Both;
+        c.source = source;
+        c.distractors = d;
+        return c;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    const int answers = args.size() > 1 ? qMax(1, args[1].toInt()) : 100000;
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+    {
+        QTextStream(stderr) << "Cannot create a temporary directory\n";
+        return 1;
+    }
+    const QString statsPath = dir.filePath("user_stats.json");
+
+    QElapsedTimer t;
+
+    // Progress updates: counters, SRS grading, journal record, history event
+    auto *progress = new ProgressManager(statsPath);
+    {
+        QuizEngine engine;
+        engine.seed(1);
+        engine.start(config(PracticeConfig::Source::All, PracticeConfig::Distractors::Random),
+                     progress);
+
+        PreparedQuestion q;
+        t.start();
+        for (int i = 0; i < answers; ++i)
+        {
+            engine.prepare(q);
+            const bool correct = i % 4 != 0;
+            progress->recordAnswer(q.item.isHiragana, q.item.id, correct,
+                                   correct ? -1 : q.optionIds[(q.correctIndex + 1) % 4],
+                                   AnswerHistory::Direction(i % 2), 800 + i % 1500);
+        }
+        report("progress.recordAnswer", answers, t.nsecsElapsed());
+    }
+
+    // Persistence: history block + snapshot compaction on shutdown, then a cold load
+    t.start();
+    delete progress;
+    report("persist.flush", 1, t.nsecsElapsed());
+
+    t.start();
+    progress = new ProgressManager(statsPath);
+    report("persist.load", 1, t.nsecsElapsed());
+
+    // Pool building for every source
+    const PracticeConfig::Source sources[] = {
+        PracticeConfig::Source::All, PracticeConfig::Source::Mastered,
+        PracticeConfig::Source::Due, PracticeConfig::Source::Confused
+    };
+    const char *poolNames[] = { "pool.all", "pool.mastered", "pool.due", "pool.confused" };
+
+    QuizEngine engine;
+    engine.seed(1);
+    const int starts = 2000;
+    for (int s = 0; s < 4; ++s)
+    {
+        const PracticeConfig c = config(sources[s], PracticeConfig::Distractors::LookAlike);
+        t.start();
+        for (int i = 0; i < starts; ++i)
+            engine.start(c, progress);
+        report(poolNames[s], starts, t.nsecsElapsed());
+    }
+
+    // Question generation, the way a session asks them
+    const PracticeConfig::Distractors kinds[] = {
+        PracticeConfig::Distractors::Random, PracticeConfig::Distractors::LookAlike
+    };
+    const char *questionNames[] = { "question.random", "question.lookalike" };
+
+    for (int k = 0; k < 2; ++k)
+    {
+        engine.start(config(PracticeConfig::Source::All, kinds[k]), progress);
+
+        PreparedQuestion q;
+        t.start();
+        for (int i = 0; i < answers; ++i)
+        {
+            engine.prepare(q);
+            engine.setCurrent(q.item);
+            engine.lookAhead();
+        }
+        report(questionNames[k], answers, t.nsecsElapsed());
+    }
+
+    engine.start(config(PracticeConfig::Source::Due, PracticeConfig::Distractors::Random),
+                 progress);
+    {
+        PreparedQuestion q;
+        t.start();
+        for (int i = 0; i < answers; ++i)
+        {
+            engine.prepare(q);
+            engine.setCurrent(q.item);
+            engine.answered(q.item, progress);
+            engine.lookAhead();
+        }
+        report("question.due", answers, t.nsecsElapsed());
+    }
+
+    // History queries
+    const AnswerHistory &history = progress->answerHistory();
+    const QDate today = QDate::currentDate();
+    t.start();
+    for (int i = 0; i < 1000; ++i)
+        history.accuracyByDay(today.addDays(-365), today);
+    report("history.accuracyByDay", 1000, t.nsecsElapsed());
+
+    t.start();
+    for (int id = 0; id < KanaCatalog::Count; ++id)
+        history.retention(true, id, 24 * 3600);
+    report("history.retention", KanaCatalog::Count, t.nsecsElapsed());
+
+    delete progress;
+    return 0;
+}
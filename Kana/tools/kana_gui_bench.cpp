@@ -0,0 +1,311 @@
+// Scripted end-to-end latency run of the real MainWindow, offscreen.
+//   kana_gui_bench [--questions N] [--rounds N] [--output file.json]
+//
+// Each interaction is timed from the synthetic input event until the event
+// queue (including the repaint it triggered) has drained. Results are
+// p50/p95/p99/max per interaction plus peak RSS, as JSON.
+
+#include "../mainwindow.h"
+#include "../kanatablepage.h"
+#include "../kanagridview.h"
+#include "../PracticeSessionPage.h"
+#include "../kanacatalog.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDialog>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QPushButton>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    QMap<QString, QVector<qint64>> samples;    // interaction -> microseconds
+
+    void settle()
+    {
+        QCoreApplication::sendPostedEvents();
+        QCoreApplication::processEvents();
+    }
+
+    template <typename F>
+    void measure(const QString &name, F action)
+    {
+        QElapsedTimer t;
+        t.start();
+        action();
+        settle();
+        samples[name].append(t.nsecsElapsed() / 1000);
+    }
+
+    void click(QWidget *w, const QPoint &pos = QPoint())
+    {
+        QTest::mouseClick(w, Qt::LeftButton, Qt::NoModifier, pos);
+    }
+
+    QPushButton *button(QWidget *page, const char *name)
+    {
+        auto *b = page->findChild<QPushButton *>(name);
+        if (!b)
+            qFatal("kana_gui_bench: no button '%s'", name);
+        return b;
+    }
+
+    qint64 percentile(const QVector<qint64> &sorted, int p)
+    {
+        const int rank = int(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[qBound(0, rank - 1, int(sorted.size()) - 1)];
+    }
+
+    qint64 peakRssKb()
+    {
+#ifdef Q_OS_WIN
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+            return qint64(pmc.PeakWorkingSetSize / 1024);
+        return -1;
+#else
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+            return -1;
+#ifdef Q_OS_MACOS
+        return ru.ru_maxrss / 1024;     // bytes there
+#else
+        return ru.ru_maxrss;
+#endif
+#endif
+    }
+}
+
+
+// Flows
+static void tableFlow(MainWindow &w, int toggles)
+{
+    QWidget *home = w.page(MainWindow::Page::Home);
+    measure("nav.kanaTable.first", [&] { click(button(home, "kanaTableButton")); });
+
+    auto *table = static_cast<KanaTablePage *>(w.page(MainWindow::Page::KanaTable));
+    QObject::connect(table, &KanaTablePage::toggleMeasured, table, [](bool, qint64 us) {
+        samples["table.toggle.paint"].append(us);
+    });
+
+    QPushButton *hira = button(table, "hiraganaButton");
+    QPushButton *kata = button(table, "katakanaButton");
+
+    for (int i = 0; i < toggles; ++i)
+        measure("table.toggle", [&] { click(i % 2 ? hira : kata); });
+
+    // One detail dialog per symbol, both scripts
+    for (QPushButton *script : { hira, kata })
+    {
+        click(script);
+        settle();
+
+        KanaGridView *grid = nullptr;
+        for (KanaGridView *g : table->findChildren<KanaGridView *>())
+            if (g->isVisible())
+                grid = g;
+        if (!grid)
+            qFatal("kana_gui_bench: no visible kana grid");
+
+        for (int id = 0; id < KanaCatalog::Count; ++id)
+        {
+            grid->ensureVisible(id);
+            settle();
+
+            const QRect cell = grid->cellRect(id);
+            if (cell.isNull())
+                continue;
+
+            QElapsedTimer t;
+            QElapsedTimer closing;
+
+            // Runs inside the dialog's exec() once it is up
+            QTimer::singleShot(0, [&] {
+                auto *dlg = qobject_cast<QDialog *>(QApplication::activeModalWidget());
+                if (!dlg)
+                    return;
+
+                settle();
+                samples["detail.open"].append(t.nsecsElapsed() / 1000);
+
+                closing.start();
+                dlg->reject();
+            });
+
+            t.start();
+            click(grid->viewport(), cell.center());
+            settle();
+
+            if (closing.isValid())
+                samples["detail.close"].append(closing.nsecsElapsed() / 1000);
+        }
+    }
+
+    measure("nav.home", [&] { click(button(table, "homeButton")); });
+}
+
+static void practiceFlow(MainWindow &w, int questions)
+{
+    QWidget *home = w.page(MainWindow::Page::Home);
+    measure("nav.practice.first", [&] { click(button(home, "practiceButton")); });
+
+    auto *session = static_cast<PracticeSessionPage *>(w.page(MainWindow::Page::PracticeSession));
+
+    PracticeConfig config;
+    config.mode = PracticeConfig::Mode::Mixed;
+    config.script = PracticeConfig::Script::Both;
+    config.questionLimit = questions;
+
+    measure("practice.start", [&] {
+        session->startSession(config);
+        w.showPage(MainWindow::Page::PracticeSession);
+    });
+
+    QPushButton *opt[4];
+    for (int i = 0; i < 4; ++i)
+        opt[i] = button(session, QString("option%1").arg(i).toLatin1().constData());
+    QPushButton *next = button(session, "nextButton");
+
+    for (int q = 0; q < questions; ++q)
+    {
+        measure("practice.answer", [&] { click(opt[q % 4]); });
+
+        // Includes the fade-out / fade-in animation
+        QElapsedTimer t;
+        t.start();
+        click(next);
+        QTest::qWaitFor([&] { return !opt[0]->isVisible() || opt[0]->isEnabled(); }, 5000);
+        settle();
+        samples["practice.next"].append(t.nsecsElapsed() / 1000);
+    }
+
+    measure("practice.exit", [&] { click(button(session, "setupButton")); });
+    w.showPage(MainWindow::Page::Home);
+    settle();
+}
+
+static void statisticsFlow(MainWindow &w, int rounds)
+{
+    QWidget *home = w.page(MainWindow::Page::Home);
+
+    for (int i = 0; i < rounds; ++i)
+    {
+        measure(i ? "nav.statistics" : "nav.statistics.first",
+                [&] { click(button(home, "statisticsButton")); });
+
+        QWidget *stats = w.page(MainWindow::Page::Statistics);
+        measure("nav.home", [&] { click(button(stats, "homeButton")); });
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // Never reach the real word service from a benchmark
+    if (qEnvironmentVariableIsEmpty("KANA_WORD_API_URL"))
+        qputenv("KANA_WORD_API_URL", "http://127.0.0.1:9/");
+
+    QApplication app(argc, argv);
+
+    // Word cache and other standard locations under test paths, not the user's
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({ "questions", "Practice questions to answer.", "n", "500" });
+    parser.addOption({ "rounds", "Table toggles / statistics visits.", "n", "100" });
+    parser.addOption({ "output", "Write the JSON report to a file.", "file" });
+    parser.process(app);
+
+    const int questions = qMax(1, parser.value("questions").toInt());
+    const int rounds    = qMax(1, parser.value("rounds").toInt());
+    const QString output = parser.isSet("output")
+                               ? QFileInfo(parser.value("output")).absoluteFilePath()
+                               : QString();
+
+    // Progress files go to a scratch directory, not the user's data
+    QTemporaryDir scratch;
+    if (!scratch.isValid() || !QDir::setCurrent(scratch.path()))
+        qFatal("kana_gui_bench: cannot create a scratch directory");
+
+    QElapsedTimer boot;
+    boot.start();
+
+    auto *w = new MainWindow();
+    w->show();
+    if (!QTest::qWaitForWindowExposed(w))
+        qFatal("kana_gui_bench: window was never exposed");
+    settle();
+    samples["startup"].append(boot.nsecsElapsed() / 1000);
+
+    tableFlow(*w, rounds);
+    practiceFlow(*w, questions);
+    statisticsFlow(*w, qMax(1, rounds / 5));
+
+    delete w;
+
+    // Report
+    QJsonObject interactions;
+    for (auto it = samples.begin(); it != samples.end(); ++it)
+    {
+        QVector<qint64> v = it.value();
+        if (v.isEmpty())
+            continue;
+        std::sort(v.begin(), v.end());
+
+        QJsonObject o;
+        o["count"]  = v.size();
+        o["p50_us"] = percentile(v, 50);
+        o["p95_us"] = percentile(v, 95);
+        o["p99_us"] = percentile(v, 99);
+        o["max_us"] = v.last();
+        interactions[it.key()] = o;
+    }
+
+    QJsonObject report;
+    report["platform"]     = QGuiApplication::platformName();
+    report["questions"]    = questions;
+    report["rounds"]       = rounds;
+    report["interactions"] = interactions;
+    report["peak_rss_kb"]  = peakRssKb();
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (!output.isEmpty())
+    {
+        QFile f(output);
+        if (!f.open(QIODevice::WriteOnly) || f.write(json) != json.size())
+        {
+            QTextStream(stderr) << "Cannot write " << f.fileName() << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
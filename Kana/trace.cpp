@@ -0,0 +1,277 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+struct Trace::ThreadState
+{
+    int  id = -1;
+    bool isGui = false;
+    int  depth = 0;
+    const char *names[MaxDepth];
+    qint64      starts[MaxDepth];
+};
+
+Trace *Trace::instance()
+{
+    // Never destroyed: spans may close during static destruction
+    static Trace *trace = new Trace();
+    return trace;
+}
+
+Trace::Trace()
+{
+    m_clock.start();
+    m_events.reserve(4096);
+}
+
+Trace::ThreadState &Trace::threadState()
+{
+    thread_local ThreadState state;
+    if (state.id < 0)
+    {
+        QThread *current = QThread::currentThread();
+        const QCoreApplication *app = QCoreApplication::instance();
+
+        state.id = m_nextThread++;
+        state.isGui = app && current == app->thread();
+
+        QString name = state.isGui ? QStringLiteral("GUI") : current->objectName();
+        if (name.isEmpty())
+            name = QStringLiteral("thread %1").arg(state.id);
+
+        QMutexLocker lock(&m_mutex);
+        m_threadNames.insert(state.id, name);
+    }
+    return state;
+}
+
+
+// Spans
+void Trace::begin(const char *name)
+{
+    ThreadState &t = threadState();
+    if (t.depth < MaxDepth)
+    {
+        t.names[t.depth]  = name;
+        t.starts[t.depth] = nowUs();
+    }
+    t.depth++;
+
+    if (t.isGui)
+    {
+        QMutexLocker lock(&m_mutex);
+        m_guiStack.append(name);
+    }
+}
+
+void Trace::end()
+{
+    ThreadState &t = threadState();
+    if (t.depth == 0)
+        return;
+
+    t.depth--;
+    if (t.depth < MaxDepth && isEnabled())
+    {
+        const qint64 start = t.starts[t.depth];
+        addEvent({ t.names[t.depth], start, nowUs() - start, t.id, QString() });
+    }
+
+    if (t.isGui)
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_guiStack.isEmpty())
+            m_guiStack.removeLast();
+    }
+}
+
+QStringList Trace::guiSpanStack() const
+{
+    QMutexLocker lock(&m_mutex);
+
+    QStringList spans;
+    spans.reserve(m_guiStack.size());
+    for (const char *name : m_guiStack)
+        spans.append(QString::fromLatin1(name));
+    return spans;
+}
+
+void Trace::addEvent(const Event &e)
+{
+    Event event = e;
+    if (event.thread < 0)
+        event.thread = threadState().id;
+
+    QMutexLocker lock(&m_mutex);
+    if (m_events.size() < MaxEvents)
+    {
+        m_events.append(event);
+        return;
+    }
+
+    // Full: keep the most recent events
+    m_events[m_next] = event;
+    m_next = (m_next + 1) % MaxEvents;
+}
+
+
+// Chrome trace-event format, complete ("X") events in microseconds
+bool Trace::exportChromeTrace(const QString &path) const
+{
+    QJsonArray events;
+    {
+        QMutexLocker lock(&m_mutex);
+
+        for (auto it = m_threadNames.cbegin(); it != m_threadNames.cend(); ++it)
+        {
+            QJsonObject meta;
+            meta["name"] = "thread_name";
+            meta["ph"]   = "M";
+            meta["pid"]  = 1;
+            meta["tid"]  = it.key();
+            meta["args"] = QJsonObject{ { "name", it.value() } };
+            events.append(meta);
+        }
+
+        for (const Event &e : m_events)
+        {
+            QJsonObject o;
+            o["name"] = QString::fromLatin1(e.name);
+            o["ph"]   = "X";
+            o["ts"]   = double(e.startUs);
+            o["dur"]  = double(e.durationUs);
+            o["pid"]  = 1;
+            o["tid"]  = e.thread;
+            if (!e.detail.isEmpty())
+            {
+                o["cat"]  = "stall";
+                o["args"] = QJsonObject{ { "spans", e.detail } };
+            }
+            events.append(o);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Cannot write trace file" << path;
+        return false;
+    }
+    f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+
+// Watchdog
+StallWatchdog::StallWatchdog(QObject *parent)
+    : QObject(parent)
+{
+    bool ok = false;
+    const int ms = qEnvironmentVariableIntValue("KANA_STALL_MS", &ok);
+    if (ok && ms > 0)
+        setThresholdMs(ms);
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+void StallWatchdog::start()
+{
+    if (m_running)
+        return;
+
+    m_running = true;
+    m_lastBeatUs = Trace::instance()->nowUs();
+
+    // Heartbeat on the GUI thread, well below the threshold
+    m_heartbeat = new QTimer(this);
+    m_heartbeat->setTimerType(Qt::PreciseTimer);
+    m_heartbeat->setInterval(qBound(5, thresholdMs() / 4, 50));
+    connect(m_heartbeat, &QTimer::timeout, this, &StallWatchdog::beat);
+    m_heartbeat->start();
+
+    m_watcher = QThread::create([this]() { watch(); });
+    m_watcher->setObjectName("StallWatchdog");
+    m_watcher->start();
+}
+
+void StallWatchdog::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    m_watcher->wait();
+    delete m_watcher;
+    m_watcher = nullptr;
+
+    delete m_heartbeat;
+    m_heartbeat = nullptr;
+}
+
+// GUI thread: the loop is alive; close a stall the watcher saw
+void StallWatchdog::beat()
+{
+    Trace *trace = Trace::instance();
+    const qint64 now  = trace->nowUs();
+    const qint64 last = m_lastBeatUs.exchange(now);
+
+    QStringList spans;
+    {
+        QMutexLocker lock(&m_stallMutex);
+        if (!m_inStall)
+            return;
+        m_inStall = false;
+        spans = m_stallSpans;
+        m_stallSpans.clear();
+    }
+
+    // The watcher can race a beat that was merely late
+    const qint64 duration = now - last;
+    if (duration <= m_thresholdUs.load())
+        return;
+
+    const QString where = spans.isEmpty() ? QStringLiteral("(no open span)")
+                                          : spans.join(" > ");
+
+    qDebug().noquote() << "GUI thread stalled for" << duration / 1000 << "ms in" << where;
+    trace->addEvent({ "stall", last, duration, -1, where });
+
+    emit stalled(duration, spans);
+}
+
+// Watcher thread: notices the missing heartbeat while the stall is on
+void StallWatchdog::watch()
+{
+    Trace *trace = Trace::instance();
+
+    while (m_running)
+    {
+        const qint64 threshold = m_thresholdUs.load();
+        QThread::msleep(ulong(qBound<qint64>(5, threshold / 4000, 50)));
+
+        if (trace->nowUs() - m_lastBeatUs.load() <= threshold)
+            continue;
+
+        // Keep the deepest stack seen during this stall
+        const QStringList spans = trace->guiSpanStack();
+
+        QMutexLocker lock(&m_stallMutex);
+        m_inStall = true;
+        if (spans.size() > m_stallSpans.size())
+            m_stallSpans = spans;
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QElapsedTimer>
+#include <atomic>
+
+class QThread;
+class QTimer;
+
+// Lightweight instrumentation.
+//
+// KANA_TRACE_SCOPE("name") marks a span for the rest of the block. The
+// span stack of every thread is always maintained (the watchdog uses the
+// GUI thread's); completed spans are only recorded while tracing is
+// enabled, and can be exported as Chrome trace-event JSON
+// (chrome://tracing, Perfetto). Names must be string literals.
+class Trace
+{
+public:
+    struct Event
+    {
+        const char *name;
+        qint64  startUs;
+        qint64  durationUs;
+        int     thread;     // -1: the calling thread
+        QString detail;     // stalls: the span stack
+    };
+
+    static Trace *instance();
+
+    void setEnabled(bool on) { m_enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    void begin(const char *name);
+    void end();
+
+    // Spans open on the GUI thread right now, outermost first
+    QStringList guiSpanStack() const;
+
+    void addEvent(const Event &e);
+    bool exportChromeTrace(const QString &path) const;
+
+private:
+    Trace();
+
+    struct ThreadState;
+    ThreadState &threadState();
+
+    static constexpr int MaxEvents = 200000;
+    static constexpr int MaxDepth  = 32;
+
+    std::atomic<bool> m_enabled { false };
+    QElapsedTimer     m_clock;
+
+    mutable QMutex    m_mutex;
+    QVector<Event>    m_events;          // ring buffer once full
+    int               m_next = 0;
+    QVector<const char *> m_guiStack;    // mirror of the GUI thread's stack
+    QHash<int, QString>   m_threadNames;
+    std::atomic<int>      m_nextThread { 0 };
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name) { Trace::instance()->begin(name); }
+    ~TraceSpan() { Trace::instance()->end(); }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+};
+
+#define KANA_TRACE_CONCAT2(a, b) a##b
+#define KANA_TRACE_CONCAT(a, b) KANA_TRACE_CONCAT2(a, b)
+#define KANA_TRACE_SCOPE(name) TraceSpan KANA_TRACE_CONCAT(kanaTraceSpan_, __LINE__)(name)
+
+// Event-loop heartbeat. A timer on the GUI thread ticks every few ms; a
+// watcher thread notices when it stops ticking for longer than the
+// threshold, grabs the GUI span stack while the stall is happening, and
+// reports the stall (qDebug + trace event) once the loop is back.
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StallWatchdog(QObject *parent = nullptr);
+    ~StallWatchdog();
+
+    // KANA_STALL_MS overrides the default of 100 ms
+    void setThresholdMs(int ms) { m_thresholdUs.store(qint64(ms) * 1000); }
+    int  thresholdMs() const { return int(m_thresholdUs.load() / 1000); }
+
+    void start();
+    void stop();
+
+signals:
+    void stalled(qint64 durationUs, const QStringList &spans);
+
+private:
+    void beat();
+    void watch();
+
+    QTimer  *m_heartbeat = nullptr;
+    QThread *m_watcher = nullptr;
+    std::atomic<bool>   m_running { false };
+    std::atomic<qint64> m_lastBeatUs { 0 };
+    std::atomic<qint64> m_thresholdUs { 100000 };
+
+    // Filled by the watcher while a stall is in progress
+    QMutex      m_stallMutex;
+    bool        m_inStall = false;
+    QStringList m_stallSpans;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,438 @@
+#include "worddictionary.h"
+#include "kanacatalog.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QtEndian>
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+static const char    DICT_MAGIC[4] = { 'K', 'D', 'I', 'C' };
+static const quint32 DICT_VERSION  = 1;
+
+// Set for readings that use a symbol outside the catalog (ぁ, ゔ, ...);
+// never part of a KanaSet, so such words don't pass the mastered filter
+static const int UNKNOWN_SYMBOL_BIT = 127;
+static_assert(KanaCatalog::Count < UNKNOWN_SYMBOL_BIT,
+              "catalog ids would collide with the unknown-symbol bit");
+
+static const char16_t SMALL_TSU_HIRA = u'っ';
+static const char16_t SMALL_TSU_KATA = u'ッ';
+static const char16_t LONG_VOWEL     = u'ー';
+
+
+// KanaSet
+void KanaSet::insert(bool isHiragana, int id)
+{
+    if (!KanaCatalog::isValid(id))
+        return;
+
+    quint64 *bits = isHiragana ? hiragana : katakana;
+    bits[id / 64] |= quint64(1) << (id % 64);
+}
+
+void KanaSet::remove(bool isHiragana, int id)
+{
+    if (!KanaCatalog::isValid(id))
+        return;
+
+    quint64 *bits = isHiragana ? hiragana : katakana;
+    bits[id / 64] &= ~(quint64(1) << (id % 64));
+}
+
+bool KanaSet::isEmpty() const
+{
+    return !(hiragana[0] | hiragana[1] | katakana[0] | katakana[1]);
+}
+
+
+// Reader
+WordDictionary *WordDictionary::instance()
+{
+    static WordDictionary *dict = []() {
+        auto *d = new WordDictionary();
+        if (!d->open(defaultPath()))
+            qDebug() << "Word dictionary not available, words come from the network";
+        return d;
+    }();
+    return dict;
+}
+
+QString WordDictionary::defaultPath()
+{
+    return QCoreApplication::applicationDirPath() + "/data/kana_words.dict";
+}
+
+bool WordDictionary::open(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(Header)))
+    {
+        m_file.close();
+        return false;
+    }
+
+    uchar *base = m_file.map(0, m_size);
+    if (!base)
+    {
+        qDebug() << "Word dictionary could not be mapped:" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    Header h;
+    std::memcpy(&h, base, sizeof(h));
+    const quint32 count = qFromLittleEndian(h.count);
+
+    const quint32 records     = qFromLittleEndian(h.records);
+    const quint32 keyIndex    = qFromLittleEndian(h.keyIndex);
+    const quint32 romajiIndex = qFromLittleEndian(h.romajiIndex);
+    const quint32 strings     = qFromLittleEndian(h.strings);
+    const quint32 stringsSize = qFromLittleEndian(h.stringsSize);
+
+    auto fits = [this](quint64 offset, quint64 bytes) {
+        return offset + bytes <= quint64(m_size);
+    };
+
+    if (std::memcmp(h.magic, DICT_MAGIC, 4) != 0 ||
+        qFromLittleEndian(h.version) != DICT_VERSION ||
+        qFromLittleEndian(h.fingerprint) != KanaCatalog::fingerprint() ||
+        !fits(records, quint64(count) * sizeof(Record)) ||
+        !fits(keyIndex, quint64(count) * 4) ||
+        !fits(romajiIndex, quint64(count) * 4) ||
+        !fits(strings, stringsSize) ||
+        stringsSize == 0 || base[strings + stringsSize - 1] != 0)
+    {
+        qDebug() << "Word dictionary does not match this build:" << path;
+        m_file.unmap(base);
+        m_file.close();
+        return false;
+    }
+
+    // Index entries go straight into record(); a damaged file must not
+    // point past the record table (string offsets are checked in string(),
+    // and the strings section is NUL-terminated, checked above)
+    for (quint32 indexOffset : { keyIndex, romajiIndex })
+    {
+        const quint32 *index = reinterpret_cast<const quint32 *>(base + indexOffset);
+        for (quint32 i = 0; i < count; ++i)
+        {
+            if (qFromLittleEndian(index[i]) >= count)
+            {
+                qDebug() << "Word dictionary index is damaged:" << path;
+                m_file.unmap(base);
+                m_file.close();
+                return false;
+            }
+        }
+    }
+
+    m_base        = base;
+    m_count       = int(count);
+    m_strings     = strings;
+    m_stringsSize = stringsSize;
+    m_keyIndex    = keyIndex;
+    m_romajiIndex = romajiIndex;
+    return true;
+}
+
+const WordDictionary::Record &WordDictionary::record(int index) const
+{
+    const quint32 records = qFromLittleEndian(reinterpret_cast<const Header *>(m_base)->records);
+    return reinterpret_cast<const Record *>(m_base + records)[index];
+}
+
+const char *WordDictionary::string(quint32 offset) const
+{
+    offset = qFromLittleEndian(offset);
+    if (offset >= m_stringsSize)
+        return "";
+    return reinterpret_cast<const char *>(m_base + m_strings + offset);
+}
+
+WordDictionary::Word WordDictionary::word(int index) const
+{
+    if (!m_base || index < 0 || index >= m_count)
+        return Word();
+
+    const Record &r = record(index);
+    return Word{ QString::fromUtf8(string(r.reading)),
+                 QString::fromUtf8(string(r.written)),
+                 QString::fromUtf8(string(r.romaji)),
+                 QString::fromUtf8(string(r.meaning)) };
+}
+
+
+// Prefix search: lower bound in a sorted index, then walk while it matches
+QVector<int> WordDictionary::findPrefix(quint32 indexOffset, quint32 Record::*field,
+                                        const QByteArray &prefix, int limit) const
+{
+    QVector<int> out;
+    if (!m_base || prefix.isEmpty())
+        return out;
+
+    const quint32 *index = reinterpret_cast<const quint32 *>(m_base + indexOffset);
+    auto text = [&](int i) {
+        return string(record(int(qFromLittleEndian(index[i]))).*field);
+    };
+
+    int lo = 0, hi = m_count;
+    while (lo < hi)
+    {
+        const int mid = (lo + hi) / 2;
+        if (std::strcmp(text(mid), prefix.constData()) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (int i = lo; i < m_count && out.size() < limit; ++i)
+    {
+        if (std::strncmp(text(i), prefix.constData(), size_t(prefix.size())) != 0)
+            break;
+        out.append(int(qFromLittleEndian(index[i])));
+    }
+    return out;
+}
+
+QVector<int> WordDictionary::findByKana(const QString &prefix, int limit) const
+{
+    QString key = prefix;
+    for (QChar &c : key)
+        c = QChar(KanaCatalog::toHiraganaUnit(c.unicode()));
+
+    return findPrefix(m_keyIndex, &Record::key, key.toUtf8(), limit);
+}
+
+QVector<int> WordDictionary::findByRomaji(const QString &prefix, int limit) const
+{
+    return findPrefix(m_romajiIndex, &Record::romaji, prefix.toLower().toUtf8(), limit);
+}
+
+// Reservoir sampling: one pass, no candidate list
+int WordDictionary::randomWord(const KanaSet *allowed, int avoid) const
+{
+    int chosen = -1;
+    int seen = 0;
+
+    for (int i = 0; i < m_count; ++i)
+    {
+        if (i == avoid)
+            continue;
+
+        if (allowed)
+        {
+            const Record &r = record(i);
+            const bool kata = qFromLittleEndian(r.flags) & KatakanaReading;
+            const quint64 *ok = kata ? allowed->katakana : allowed->hiragana;
+
+            if ((qFromLittleEndian(r.mask[0]) & ~ok[0]) ||
+                (qFromLittleEndian(r.mask[1]) & ~ok[1]))
+                continue;
+        }
+
+        if (QRandomGenerator::global()->bounded(++seen) == 0)
+            chosen = i;
+    }
+    return chosen;
+}
+
+
+// Writer (build step)
+namespace
+{
+    struct Entry
+    {
+        QByteArray reading, written, romaji, meaning, key;
+        quint32    flags = 0;
+        quint64    mask[2] = {};
+    };
+
+    // Reading -> romaji and symbol mask, using the catalog's own romaji.
+    // っ doubles the next consonant, ー repeats the last vowel.
+    void analyse(const QString &reading, Entry &e)
+    {
+        QString romaji;
+        bool doubleNext = false;
+
+        auto setBit = [&e](int bit) { e.mask[bit / 64] |= quint64(1) << (bit % 64); };
+
+        for (int i = 0; i < reading.size(); ++i)
+        {
+            const char16_t c = reading[i].unicode();
+
+            if (c == SMALL_TSU_HIRA || c == SMALL_TSU_KATA)
+            {
+                doubleNext = true;
+                continue;
+            }
+
+            if (c == LONG_VOWEL)
+            {
+                if (!romaji.isEmpty())
+                    romaji += romaji.back();
+                continue;
+            }
+
+            int id = -1;
+            if (i + 1 < reading.size())
+            {
+                id = KanaCatalog::idOf(c, reading[i + 1].unicode());
+                if (id >= 0)
+                    ++i;
+            }
+            if (id < 0)
+                id = KanaCatalog::idOf(c, 0);
+
+            if (id < 0)
+            {
+                setBit(UNKNOWN_SYMBOL_BIT);
+                continue;
+            }
+
+            setBit(id);
+
+            QString r = KanaCatalog::displayRomaji(id);
+            if (doubleNext)
+            {
+                r.prepend(r.startsWith("ch") ? QChar('t') : r.front());
+                doubleNext = false;
+            }
+            romaji += r;
+        }
+
+        QString key = reading;
+        for (QChar &ch : key)
+            ch = QChar(KanaCatalog::toHiraganaUnit(ch.unicode()));
+
+        const char16_t first = reading.isEmpty() ? 0 : reading[0].unicode();
+        if (first >= KanaCatalog::HiraganaFirst + KanaCatalog::KatakanaShift &&
+            first <= KanaCatalog::HiraganaLast + KanaCatalog::KatakanaShift)
+            e.flags |= 1;   // KatakanaReading
+
+        e.romaji = romaji.toUtf8();
+        e.key    = key.toUtf8();
+    }
+}
+
+bool WordDictionary::build(const QString &tsvPath, const QString &outPath)
+{
+    QFile in(tsvPath);
+    if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "Cannot read word list:" << tsvPath;
+        return false;
+    }
+
+    QVector<Entry> entries;
+    QTextStream ts(&in);
+    ts.setEncoding(QStringConverter::Utf8);
+
+    while (!ts.atEnd())
+    {
+        const QString line = ts.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const QStringList cols = line.split('\t');
+        if (cols.size() < 3)
+        {
+            qDebug() << "Skipping malformed word line:" << line;
+            continue;
+        }
+
+        Entry e;
+        e.reading = cols[0].toUtf8();
+        e.written = cols[1].toUtf8();
+        e.meaning = cols[2].toUtf8();
+        analyse(cols[0], e);
+        entries.append(e);
+    }
+
+    // Strings, deduplicated
+    QByteArray strings;
+    QHash<QByteArray, quint32> stringOffsets;
+    auto intern = [&](const QByteArray &s) {
+        auto it = stringOffsets.constFind(s);
+        if (it != stringOffsets.constEnd())
+            return *it;
+
+        const quint32 offset = quint32(strings.size());
+        strings.append(s);
+        strings.append('\0');
+        stringOffsets.insert(s, offset);
+        return offset;
+    };
+
+    QVector<Record> records;
+    records.reserve(entries.size());
+    for (const Entry &e : entries)
+    {
+        Record r;
+        r.reading = qToLittleEndian(intern(e.reading));
+        r.written = qToLittleEndian(intern(e.written));
+        r.romaji  = qToLittleEndian(intern(e.romaji));
+        r.meaning = qToLittleEndian(intern(e.meaning));
+        r.key     = qToLittleEndian(intern(e.key));
+        r.flags   = qToLittleEndian(e.flags);
+        r.mask[0] = qToLittleEndian(e.mask[0]);
+        r.mask[1] = qToLittleEndian(e.mask[1]);
+        records.append(r);
+    }
+
+    auto sortedBy = [&entries](QByteArray Entry::*field) {
+        QVector<quint32> order(entries.size());
+        for (int i = 0; i < order.size(); ++i)
+            order[i] = quint32(i);
+
+        std::stable_sort(order.begin(), order.end(), [&](quint32 a, quint32 b) {
+            return entries[a].*field < entries[b].*field;
+        });
+
+        for (quint32 &v : order)
+            v = qToLittleEndian(v);
+        return order;
+    };
+
+    const QVector<quint32> keyIndex    = sortedBy(&Entry::key);
+    const QVector<quint32> romajiIndex = sortedBy(&Entry::romaji);
+
+    const quint32 count = quint32(entries.size());
+
+    Header h = {};
+    std::memcpy(h.magic, DICT_MAGIC, 4);
+    h.version     = qToLittleEndian(DICT_VERSION);
+    h.count       = qToLittleEndian(count);
+    h.fingerprint = qToLittleEndian(KanaCatalog::fingerprint());
+    h.records     = quint32(sizeof(Header));
+    h.keyIndex    = h.records + count * quint32(sizeof(Record));
+    h.romajiIndex = h.keyIndex + count * 4;
+    h.strings     = h.romajiIndex + count * 4;
+    h.stringsSize = quint32(strings.size());
+
+    for (quint32 *v : { &h.records, &h.keyIndex, &h.romajiIndex, &h.strings, &h.stringsSize })
+        *v = qToLittleEndian(*v);
+
+    QSaveFile out(outPath);
+    if (!out.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Cannot write word dictionary:" << outPath << out.errorString();
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char *>(records.constData()), records.size() * sizeof(Record));
+    out.write(reinterpret_cast<const char *>(keyIndex.constData()), keyIndex.size() * 4);
+    out.write(reinterpret_cast<const char *>(romajiIndex.constData()), romajiIndex.size() * 4);
+    out.write(strings);
+    return out.commit();
+}
@@ -0,0 +1,107 @@
+#ifndef WORDDICTIONARY_H
+#define WORDDICTIONARY_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Set of kana symbols, one bit per catalog id and script
+struct KanaSet
+{
+    quint64 hiragana[2] = {};
+    quint64 katakana[2] = {};
+
+    void insert(bool isHiragana, int id);
+    void remove(bool isHiragana, int id);
+    bool isEmpty() const;
+};
+
+// Offline word list, built from data/words.tsv into a compact binary file.
+//
+// Layout (little endian):
+//   Header    magic "KDIC", version, count, catalog fingerprint, section offsets
+//   Records   count * { reading, written, romaji, meaning, key (string offsets),
+//                       flags, symbol mask (2 x quint64) }
+//   Index     record numbers sorted by key (reading folded to hiragana)
+//   Index     record numbers sorted by romaji
+//   Strings   NUL-terminated UTF-8
+//
+// The file is memory-mapped; prefix searches are binary searches over the
+// two indexes, and the mastered-kana filter is a mask test per record.
+class WordDictionary
+{
+public:
+    struct Word
+    {
+        QString reading;
+        QString written;
+        QString romaji;
+        QString meaning;
+    };
+
+    static WordDictionary *instance();
+    static QString defaultPath();
+
+    bool open(const QString &path);
+    bool isOpen() const { return m_base != nullptr; }
+    int  size() const { return m_count; }
+
+    Word word(int index) const;
+
+    // Record numbers whose reading (Hiragana or Katakana) / romaji starts with prefix
+    QVector<int> findByKana(const QString &prefix, int limit = 20) const;
+    QVector<int> findByRomaji(const QString &prefix, int limit = 20) const;
+
+    // Uniformly random record, optionally only words spelled with `allowed`
+    // symbols; `avoid` is skipped (the word shown last). -1 if none fits.
+    int randomWord(const KanaSet *allowed = nullptr, int avoid = -1) const;
+
+    // Build step: data/words.tsv -> binary dictionary
+    static bool build(const QString &tsvPath, const QString &outPath);
+
+private:
+    struct Header
+    {
+        char    magic[4];
+        quint32 version;
+        quint32 count;
+        quint32 fingerprint;
+        quint32 records;
+        quint32 keyIndex;
+        quint32 romajiIndex;
+        quint32 strings;
+        quint32 stringsSize;
+        quint32 reserved;      // keeps Record (8-byte aligned) aligned
+    };
+
+    struct Record
+    {
+        quint32 reading;
+        quint32 written;
+        quint32 romaji;
+        quint32 meaning;
+        quint32 key;
+        quint32 flags;
+        quint64 mask[2];
+    };
+
+    enum Flags : quint32 { KatakanaReading = 1 };
+
+    const Record &record(int index) const;
+    const char *string(quint32 offset) const;
+    QVector<int> findPrefix(quint32 indexOffset, quint32 Record::*field,
+                            const QByteArray &prefix, int limit) const;
+
+    QFile        m_file;
+    const uchar *m_base = nullptr;
+    qint64       m_size = 0;
+    int          m_count = 0;
+    quint32      m_strings = 0;
+    quint32      m_stringsSize = 0;
+    quint32      m_keyIndex = 0;
+    quint32      m_romajiIndex = 0;
+};
+
+#endif // WORDDICTIONARY_H